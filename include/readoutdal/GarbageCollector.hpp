@@ -0,0 +1,65 @@
+/**
+ * @file GarbageCollector.hpp
+ *
+ * Removal of objects left in the output database by earlier calls to
+ * generate_modules() which are no longer produced by the current
+ * configuration
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef GARBAGECOLLECTOR_HPP
+#define GARBAGECOLLECTOR_HPP
+
+#include <string>
+#include <vector>
+
+namespace dunedaq::coredal {
+  class DaqModule;
+  class Session;
+}
+namespace dunedaq::oksdbinterfaces {
+  class Configuration;
+}
+namespace dunedaq::readoutdal {
+
+  /**
+   * Remove stale generated objects from the given database files.
+   *
+   * A DaqModule stored in one of dbfiles is considered stale if it is not in
+   * the live list and no other object refers to it (generated modules
+   * are never referenced since the applications create them on the
+   * fly), as is any other generated object in dbfiles that nothing
+   * refers to (e.g. a configuration variant no DLH uses any more).
+   * Other generated objects stored in dbfiles which are only
+   * used by stale modules (connections, configuration variants) are
+   * removed along with them. Only objects named as the generators name
+   * them are considered, so user objects are never removed.
+   *
+   * @param live    The modules produced by the current generation
+   * @param dry_run If true only report what would be removed
+   * @return The UIDs of the removed (or removable) objects
+   */
+  std::vector<std::string>
+  remove_stale_objects(oksdbinterfaces::Configuration* confdb,
+                       const std::vector<std::string>& dbfiles,
+                       const std::vector<const coredal::DaqModule*>& live,
+                       bool dry_run = false);
+
+  /**
+   * Regenerate the modules of every SmartDaqApplication of the session
+   * into dbfile (or the per application files and the shared file,
+   * see generate_session_modules()) and remove any generated objects
+   * they no longer produce.
+   */
+  std::vector<std::string>
+  collect_garbage(oksdbinterfaces::Configuration* confdb,
+                  const std::string& dbfile,
+                  const coredal::Session* session,
+                  bool dry_run = false,
+                  bool per_app_files = false);
+
+} // namespace dunedaq::readoutdal
+#endif // GARBAGECOLLECTOR_HPP
@@ -0,0 +1,223 @@
+/**
+ * @file SessionSnapshot.hpp
+ *
+ * Read-only binary snapshot of the objects generated for a Session.
+ *
+ * A snapshot holds every generated DaqModule, its connections and all
+ * the configuration objects reachable from them (LinkHandlerConf,
+ * LatencyBuffer, NICReceiverConf...) in a flat, versioned format which
+ * is mapped into memory and queried in place, avoiding the cost of
+ * loading and parsing the OKS XML files at process start.
+ *
+ * File layout (host byte order, every section 8 byte aligned):
+ *   Header
+ *   ApplicationRecord[n_applications]  sorted by UID
+ *   uint32_t module_index[n_modules]   object indices, per application
+ *   ObjectRecord[n_objects]            sorted by UID then class
+ *   ValueRecord[n_values]              attribute values, per object
+ *   RefRecord[n_refs]                  relationship targets, per object
+ *   char strings[strings_size]         NUL terminated strings
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef SESSIONSNAPSHOT_HPP
+#define SESSIONSNAPSHOT_HPP
+
+#include "readoutdal/SessionUtils.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace dunedaq::oksdbinterfaces {
+  class Configuration;
+}
+namespace dunedaq::readoutdal {
+
+  namespace snapshot {
+    constexpr char magic[8] = {'R', 'O', 'D', 'A', 'L', 'S', 'N', 'P'};
+    constexpr uint32_t format_version = 1;
+    constexpr uint32_t byte_order_mark = 0x01020304;
+
+    enum ValueType : uint8_t { kBool, kSigned, kUnsigned, kFloat, kString };
+
+    struct Header {
+      char magic[8];
+      uint32_t version;
+      uint32_t byte_order;
+      uint32_t n_applications;
+      uint32_t n_modules;
+      uint32_t n_objects;
+      uint32_t n_values;
+      uint32_t n_refs;
+      uint32_t reserved;
+      uint64_t applications_offset;
+      uint64_t modules_offset;
+      uint64_t objects_offset;
+      uint64_t values_offset;
+      uint64_t refs_offset;
+      uint64_t strings_offset;
+      uint64_t strings_size;
+    };
+
+    struct ApplicationRecord {
+      uint32_t uid;           // string offset
+      uint32_t first_module;  // index into module_index
+      uint32_t n_modules;
+      uint32_t reserved;
+    };
+
+    struct ObjectRecord {
+      uint32_t uid;           // string offset
+      uint32_t class_name;    // string offset
+      uint32_t first_value;
+      uint32_t n_values;
+      uint32_t first_ref;
+      uint32_t n_refs;
+    };
+
+    /// Multi-value attributes are stored as consecutive records with the same name
+    struct ValueRecord {
+      uint32_t name;          // string offset
+      uint8_t type;           // ValueType
+      uint8_t reserved[3];
+      uint64_t data;          // value, bits of a double or string offset
+    };
+
+    /// Multi-value relationships are stored as consecutive records with the same name
+    struct RefRecord {
+      uint32_t name;          // string offset
+      uint32_t target;        // object index
+    };
+  } // namespace snapshot
+
+  /**
+   * Write the objects generated for a session (as returned by
+   * generate_session_modules()) and everything they refer to into a
+   * snapshot file.
+   */
+  void write_session_snapshot(oksdbinterfaces::Configuration* confdb,
+                              const std::vector<GeneratedApplication>& generated,
+                              const std::string& filename);
+
+  /**
+   * Memory mapped, read-only view of a snapshot file. Objects and
+   * strings returned by it point into the mapping and are only valid
+   * for the lifetime of the SessionSnapshot.
+   */
+  class SessionSnapshot {
+  public:
+    class Object {
+    public:
+      std::string_view UID() const;
+      std::string_view class_name() const;
+
+      /// True if the object has an attribute or relationship called name
+      bool has(std::string_view name) const;
+
+      /// Value of a single-value attribute, throws BadSnapshot if missing
+      template <typename T> T get(std::string_view name) const;
+
+      /// All values of a (multi-value) attribute
+      template <typename T> std::vector<T> get_values(std::string_view name) const;
+
+      /// Target of a single relationship, empty if not set
+      std::optional<Object> get_obj(std::string_view name) const;
+
+      /// All targets of a (multi-value) relationship
+      std::vector<Object> get_objs(std::string_view name) const;
+
+    private:
+      friend class SessionSnapshot;
+      Object(const SessionSnapshot* snapshot, const snapshot::ObjectRecord* record) :
+        m_snapshot(snapshot), m_record(record) {}
+
+      std::vector<const snapshot::ValueRecord*> find_values(std::string_view name) const;
+      [[noreturn]] void missing_value(std::string_view name) const;
+
+      const SessionSnapshot* m_snapshot;
+      const snapshot::ObjectRecord* m_record;
+    };
+
+    explicit SessionSnapshot(const std::string& filename);
+    ~SessionSnapshot();
+
+    SessionSnapshot(const SessionSnapshot&) = delete;
+    SessionSnapshot& operator=(const SessionSnapshot&) = delete;
+
+    uint32_t version() const { return m_header->version; }
+
+    /// UIDs of the applications in the snapshot
+    std::vector<std::string_view> applications() const;
+
+    /// Modules generated for application app_uid
+    std::vector<Object> modules(std::string_view app_uid) const;
+
+    /// Look up an object by UID and optionally class
+    std::optional<Object> find(std::string_view uid,
+                               std::string_view class_name = {}) const;
+
+  private:
+    std::string_view string_at(uint32_t offset) const;
+
+    void* m_data = nullptr;
+    size_t m_size = 0;
+    const snapshot::Header* m_header = nullptr;
+    const snapshot::ApplicationRecord* m_applications = nullptr;
+    const uint32_t* m_modules = nullptr;
+    const snapshot::ObjectRecord* m_objects = nullptr;
+    const snapshot::ValueRecord* m_values = nullptr;
+    const snapshot::RefRecord* m_refs = nullptr;
+    const char* m_strings = nullptr;
+  };
+
+  namespace snapshot {
+    template <typename T>
+    T decode(const ValueRecord& rec, std::string_view str) {
+      if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, std::string>) {
+        return T(str);
+      }
+      else if constexpr (std::is_floating_point_v<T>) {
+        double val;
+        std::memcpy(&val, &rec.data, sizeof(val));
+        return static_cast<T>(val);
+      }
+      else if constexpr (std::is_signed_v<T>) {
+        return static_cast<T>(static_cast<int64_t>(rec.data));
+      }
+      else {
+        return static_cast<T>(rec.data);
+      }
+    }
+  } // namespace snapshot
+
+  template <typename T>
+  T SessionSnapshot::Object::get(std::string_view name) const {
+    auto values = get_values<T>(name);
+    if (values.empty()) {
+      missing_value(name);
+    }
+    return values[0];
+  }
+
+  template <typename T>
+  std::vector<T> SessionSnapshot::Object::get_values(std::string_view name) const {
+    std::vector<T> values;
+    for (auto rec : find_values(name)) {
+      values.push_back(snapshot::decode<T>(*rec,
+                                           rec->type == snapshot::kString ?
+                                           m_snapshot->string_at(rec->data) :
+                                           std::string_view()));
+    }
+    return values;
+  }
+
+} // namespace dunedaq::readoutdal
+#endif // SESSIONSNAPSHOT_HPP
@@ -0,0 +1,100 @@
+/**
+ * @file SessionUtils.hpp
+ *
+ * Session level helpers for generating the DaqModules of all the
+ * SmartDaqApplications in a Session
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef SESSIONUTILS_HPP
+#define SESSIONUTILS_HPP
+
+#include <string>
+#include <vector>
+
+namespace dunedaq::coredal {
+  class Application;
+  class DaqModule;
+  class Session;
+}
+namespace dunedaq::oksdbinterfaces {
+  class Configuration;
+}
+namespace dunedaq::readoutdal {
+  class SmartDaqApplication;
+
+  /**
+   * The modules generated on the fly for one SmartDaqApplication
+   */
+  struct GeneratedApplication {
+    const SmartDaqApplication* application;
+    std::vector<const coredal::DaqModule*> modules;
+    std::string dbfile; ///< The file the modules were generated in
+  };
+
+  /**
+   * Return all the enabled SmartDaqApplications of the session,
+   * descending into nested Segments.
+   */
+  std::vector<const SmartDaqApplication*>
+  get_smart_applications(const coredal::Session* session);
+
+  /**
+   * Return the UID of the host that app runs on: the PhysicalHost of
+   * its VirtualHost if known, otherwise the VirtualHost itself.
+   */
+  std::string
+  application_host(const coredal::Application* app);
+
+  /**
+   * Return the IP address of the first NetworkDevice used by the
+   * VirtualHost that app runs on, or an empty string if there is none.
+   */
+  std::string
+  application_data_ip(const coredal::Application* app);
+
+  /**
+   * Return the name of the OKS file holding the generated objects
+   * that several applications use (such as configuration variants and
+   * connections between applications) when generating with one file
+   * per application. The file, <db>-shared.data.xml, is created next
+   * to dbfile with the same includes as dbfile except for the
+   * per-application files, and is included from dbfile.
+   */
+  std::string
+  shared_dbfile(oksdbinterfaces::Configuration* confdb,
+                const std::string& dbfile);
+
+  /**
+   * Return the name of the OKS file holding the generated objects of
+   * app when generating with one file per application. The file,
+   * named after dbfile and the application UID, is created next to
+   * dbfile with the same includes as dbfile except for the files of
+   * other applications, plus the shared_dbfile(), and is added to the
+   * includes of dbfile if it is not already there. Shared objects
+   * generated for app from now on go into the shared_dbfile().
+   */
+  std::string
+  application_dbfile(oksdbinterfaces::Configuration* confdb,
+                     const std::string& dbfile,
+                     const SmartDaqApplication* app);
+
+  /**
+   * Call generate_modules() for every enabled SmartDaqApplication of
+   * the session, creating the objects in dbfile or, if
+   * per_app_files is set, in each application's own
+   * application_dbfile(). The network ports and CPU cores allocated
+   * for the session are reset first so that a complete generation is
+   * reproducible.
+   */
+  std::vector<GeneratedApplication>
+  generate_session_modules(oksdbinterfaces::Configuration* confdb,
+                           const std::string& dbfile,
+                           const coredal::Session* session,
+                           bool per_app_files = false);
+
+} // namespace dunedaq::readoutdal
+#endif // SESSIONUTILS_HPP
@@ -0,0 +1,79 @@
+/**
+ * @file SessionValidator.hpp
+ *
+ * Checks of the resources needed by the modules generated for a
+ * Session against what the hosts they run on provide
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef SESSIONVALIDATOR_HPP
+#define SESSIONVALIDATOR_HPP
+
+#include "readoutdal/SessionUtils.hpp"
+
+#include <string>
+#include <vector>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * Demand on, and capacity of, one resource of the session
+   */
+  struct ResourceUsage {
+    std::string resource;
+    double demand;
+    double capacity; // 0 if not known
+    std::string unit;
+
+    bool oversubscribed() const { return capacity > 0 && demand > capacity; }
+  };
+
+  /**
+   * Memory preallocated by the latency buffers of the generated DLHs
+   * and TPHandlers and by their input queues, per host and per NUMA
+   * node, with hugepage demand counted separately for buffers using
+   * the intrinsic allocator, plus the write buffers of asynchronous
+   * DataWriters. Capacities come from ReadoutHost.
+   *
+   * Every oversubscribed resource is reported as a warning or, if
+   * strict, the first one is thrown as a BadConf.
+   */
+  std::vector<ResourceUsage>
+  validate_memory(const std::vector<GeneratedApplication>& generated,
+                  bool strict = false);
+
+  /**
+   * Threads used by the generated modules per host (DLH
+   * handlier_threads plus one for TP generation if the DataProcessor
+   * has it enabled, TPHandler handler_threads, NICReceiver lcores
+   * from eal_args, one per other DataReader) against the number of
+   * distinct cores of the ProcessingResources of the host and of the
+   * RoHwConfigs of the ReadoutApplications on it.
+   */
+  std::vector<ResourceUsage>
+  validate_cpu(const std::vector<GeneratedApplication>& generated,
+               bool strict = false);
+
+  /**
+   * Expected bandwidth of the streams of each generated NICReceiver
+   * (packet rate of the stream times the expected_packet_size of the
+   * NICStatsConf) against the link_speed_mbps of its NICReceiverConf
+   * for each of its interfaces, and of the streams arriving on each
+   * rx_iface of each host against one link.
+   */
+  std::vector<ResourceUsage>
+  validate_bandwidth(const std::vector<GeneratedApplication>& generated,
+                     bool strict = false);
+
+  /**
+   * Run all the checks above, returning all the usages
+   */
+  std::vector<ResourceUsage>
+  validate_session(const std::vector<GeneratedApplication>& generated,
+                   bool strict = false);
+
+} // namespace dunedaq::readoutdal
+#endif // SESSIONVALIDATOR_HPP
@@ -15,7 +15,9 @@
 
 #include "readoutdal/DFApplication.hpp"
 #include "readoutdal/DFOApplication.hpp"
+#include "readoutdal/GarbageCollector.hpp"
 #include "readoutdal/ReadoutApplication.hpp"
+#include "readoutdal/SessionUtils.hpp"
 #include "readoutdal/TPWriterApplication.hpp"
 
 #include <sstream>
@@ -106,6 +108,28 @@ namespace dunedaq::readoutdal::python {
     return mods;
   }
 
+  std::vector<std::string>
+  session_collect_garbage(const oksdbinterfaces::Configuration& confdb,
+                          const std::string& dbfile,
+                          const std::string& session_id,
+                          bool dry_run,
+                          bool per_app_files) {
+    auto session =
+      const_cast<oksdbinterfaces::Configuration&>(confdb).get<coredal::Session>(session_id);
+    return collect_garbage(const_cast<oksdbinterfaces::Configuration*>(&confdb),
+                           dbfile, session, dry_run, per_app_files);
+  }
+
+  std::string
+  smart_application_dbfile(const oksdbinterfaces::Configuration& confdb,
+                           const std::string& dbfile,
+                           const std::string& app_id) {
+    auto app =
+      const_cast<oksdbinterfaces::Configuration&>(confdb).get<SmartDaqApplication>(app_id);
+    return application_dbfile(const_cast<oksdbinterfaces::Configuration*>(&confdb),
+                              dbfile, app);
+  }
+
 void
 register_dal_methods(py::module& m)
 {
@@ -119,6 +143,8 @@ register_dal_methods(py::module& m)
   m.def("df_application_generate", &df_application_generate, "Generate DaqModules required by DFApplication");
   m.def("dfo_application_generate", &dfo_application_generate, "Generate DaqModules required by DFOApplication");
   m.def("tpwriter_application_generate", &tpwriter_application_generate, "Generate DaqModules required by TPWriterApplication");
+  m.def("session_collect_garbage", &session_collect_garbage, "Remove stale generated objects from the database", py::arg("confdb"), py::arg("dbfile"), py::arg("session_id"), py::arg("dry_run") = false, py::arg("per_app_files") = false);
+  m.def("application_dbfile", &smart_application_dbfile, "Get (creating if needed) the database file for the generated objects of one application");
 }
 
 } // namespace dunedaq::readoutdal::python
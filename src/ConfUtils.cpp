@@ -0,0 +1,157 @@
+/**
+ * @file ConfUtils.cpp
+ *
+ * Implementation of the generic object helpers used by the
+ * generate_modules implementations
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "ConfUtils.hpp"
+
+#include "oksdbinterfaces/Schema.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace dunedaq;
+using namespace dunedaq::readoutdal;
+
+template <typename T>
+static void
+copy_attribute(oksdbinterfaces::ConfigObject& src,
+               oksdbinterfaces::ConfigObject& dst,
+               const oksdbinterfaces::attribute_t& attr) {
+  if (attr.p_is_multi_value) {
+    std::vector<T> values;
+    src.get(attr.p_name, values);
+    dst.set_by_val<std::vector<T>>(attr.p_name, values);
+  }
+  else {
+    T value;
+    src.get(attr.p_name, value);
+    dst.set_by_val<T>(attr.p_name, value);
+  }
+}
+
+static bool
+is_multi(const oksdbinterfaces::relationship_t& rel) {
+  return rel.p_cardinality == oksdbinterfaces::zero_or_many ||
+    rel.p_cardinality == oksdbinterfaces::one_or_many;
+}
+
+template <typename T>
+static void
+clear_values(oksdbinterfaces::ConfigObject& obj, const std::string& name) {
+  obj.set_by_val<std::vector<T>>(name, {});
+}
+
+void
+dunedaq::readoutdal::reset_object(oksdbinterfaces::Configuration* confdb,
+                                  oksdbinterfaces::ConfigObject& obj) {
+  const auto& cinfo = confdb->get_class_info(obj.class_name());
+  for (const auto& attr : cinfo.p_attributes) {
+    if (attr.p_is_multi_value) {
+      switch (attr.p_type) {
+      case oksdbinterfaces::bool_type: clear_values<bool>(obj, attr.p_name); break;
+      case oksdbinterfaces::s8_type: clear_values<int8_t>(obj, attr.p_name); break;
+      case oksdbinterfaces::u8_type: clear_values<uint8_t>(obj, attr.p_name); break;
+      case oksdbinterfaces::s16_type: clear_values<int16_t>(obj, attr.p_name); break;
+      case oksdbinterfaces::u16_type: clear_values<uint16_t>(obj, attr.p_name); break;
+      case oksdbinterfaces::s32_type: clear_values<int32_t>(obj, attr.p_name); break;
+      case oksdbinterfaces::u32_type: clear_values<uint32_t>(obj, attr.p_name); break;
+      case oksdbinterfaces::s64_type: clear_values<int64_t>(obj, attr.p_name); break;
+      case oksdbinterfaces::u64_type: clear_values<uint64_t>(obj, attr.p_name); break;
+      case oksdbinterfaces::float_type: clear_values<float>(obj, attr.p_name); break;
+      case oksdbinterfaces::double_type: clear_values<double>(obj, attr.p_name); break;
+      default: clear_values<std::string>(obj, attr.p_name); break;
+      }
+    }
+    else if (attr.p_type == oksdbinterfaces::string_type ||
+             attr.p_type == oksdbinterfaces::enum_type) {
+      obj.set_by_val<std::string>(attr.p_name, attr.p_default_value);
+    }
+    // Numeric attributes are always set by the generators
+  }
+  // Required relationships (e.g. the configuration of a module) are
+  // emptied too, skipping the OKS cardinality check: the generator
+  // sets them again straight away
+  for (const auto& rel : cinfo.p_relationships) {
+    if (is_multi(rel)) {
+      obj.set_objs(rel.p_name, {}, true);
+    }
+    else {
+      obj.set_obj(rel.p_name, nullptr, true);
+    }
+  }
+}
+
+void
+dunedaq::readoutdal::clone_object(oksdbinterfaces::Configuration* confdb,
+                                  const std::string& dbfile,
+                                  const oksdbinterfaces::ConfigObject& src,
+                                  const std::string& uid,
+                                  oksdbinterfaces::ConfigObject& copy,
+                                  bool shared) {
+  auto source = src;
+  create_object(confdb, dbfile, source.class_name(), uid, copy, shared);
+
+  const auto& cinfo = confdb->get_class_info(source.class_name());
+  for (const auto& attr : cinfo.p_attributes) {
+    switch (attr.p_type) {
+    case oksdbinterfaces::bool_type: copy_attribute<bool>(source, copy, attr); break;
+    case oksdbinterfaces::s8_type: copy_attribute<int8_t>(source, copy, attr); break;
+    case oksdbinterfaces::u8_type: copy_attribute<uint8_t>(source, copy, attr); break;
+    case oksdbinterfaces::s16_type: copy_attribute<int16_t>(source, copy, attr); break;
+    case oksdbinterfaces::u16_type: copy_attribute<uint16_t>(source, copy, attr); break;
+    case oksdbinterfaces::s32_type: copy_attribute<int32_t>(source, copy, attr); break;
+    case oksdbinterfaces::u32_type: copy_attribute<uint32_t>(source, copy, attr); break;
+    case oksdbinterfaces::s64_type: copy_attribute<int64_t>(source, copy, attr); break;
+    case oksdbinterfaces::u64_type: copy_attribute<uint64_t>(source, copy, attr); break;
+    case oksdbinterfaces::float_type: copy_attribute<float>(source, copy, attr); break;
+    case oksdbinterfaces::double_type: copy_attribute<double>(source, copy, attr); break;
+    default: copy_attribute<std::string>(source, copy, attr); break;
+    }
+  }
+  for (const auto& rel : cinfo.p_relationships) {
+    if (is_multi(rel)) {
+      std::vector<oksdbinterfaces::ConfigObject> targets;
+      source.get(rel.p_name, targets);
+      std::vector<const oksdbinterfaces::ConfigObject*> ptrs;
+      for (auto& target : targets) {
+        ptrs.push_back(&target);
+      }
+      copy.set_objs(rel.p_name, ptrs);
+    }
+    else {
+      oksdbinterfaces::ConfigObject target;
+      source.get(rel.p_name, target);
+      copy.set_obj(rel.p_name, target.is_null() ? nullptr : &target);
+    }
+  }
+}
+
+std::vector<oksdbinterfaces::ConfigObject>
+dunedaq::readoutdal::referenced_objects(oksdbinterfaces::Configuration* confdb,
+                                        const oksdbinterfaces::ConfigObject& obj) {
+  auto source = obj;
+  std::vector<oksdbinterfaces::ConfigObject> refs;
+  const auto& cinfo = confdb->get_class_info(source.class_name());
+  for (const auto& rel : cinfo.p_relationships) {
+    if (is_multi(rel)) {
+      std::vector<oksdbinterfaces::ConfigObject> targets;
+      source.get(rel.p_name, targets);
+      refs.insert(refs.end(), targets.begin(), targets.end());
+    }
+    else {
+      oksdbinterfaces::ConfigObject target;
+      source.get(rel.p_name, target);
+      if (!target.is_null()) {
+        refs.push_back(target);
+      }
+    }
+  }
+  return refs;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file ConfUtils.hpp
+ *
+ * Helpers shared by the generate_modules implementations
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef CONFUTILS_HPP
+#define CONFUTILS_HPP
+
+#include "GenerationPass.hpp"
+#include "PortAllocator.hpp"
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include "coredal/Session.hpp"
+
+#include "readoutdal/NetworkConnectionDescriptor.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * Reset the relationships, multi-value attributes and string
+   * attributes of obj to empty or their default values, so that an
+   * object reused by create_object() keeps nothing that the current
+   * generation does not set again.
+   */
+  void reset_object(oksdbinterfaces::Configuration* confdb,
+                    oksdbinterfaces::ConfigObject& obj);
+
+  /**
+   * Create a new object in dbfile or, if an object of the same class
+   * and UID already exists (e.g. from an earlier generation), fetch
+   * it, move it to dbfile if it is in another file (e.g. when
+   * switching to one file per application) and reset it with
+   * reset_object() so that it can be set up again. This allows
+   * generate_modules to be rerun against the same database. Unless shared is set (for objects such as the DFO's
+   * inputs that several applications generate on purpose) the object
+   * is claimed for the application being generated in the current
+   * GenerationPass.
+   */
+  inline void create_object(oksdbinterfaces::Configuration* confdb,
+                            const std::string& dbfile,
+                            const std::string& class_name,
+                            const std::string& uid,
+                            oksdbinterfaces::ConfigObject& obj,
+                            bool shared = false) {
+    if (!shared) {
+      GenerationPass::instance().claim(class_name, uid);
+    }
+    if (confdb->test_object(class_name, uid)) {
+      confdb->get(class_name, uid, obj);
+      if (std::filesystem::weakly_canonical(obj.contained_in()) !=
+          std::filesystem::weakly_canonical(dbfile)) {
+        TLOG_DEBUG(7) << "Moving " << uid << "@" << class_name << " from "
+                      << obj.contained_in() << " to " << dbfile;
+        obj.move(dbfile);
+      }
+      reset_object(confdb, obj);
+    }
+    else {
+      confdb->create(dbfile, class_name, uid, obj);
+    }
+  }
+
+  /**
+   * Make a copy of src with the given UID in dbfile, copying all its
+   * attributes and relationships (not the objects they point to). If
+   * the copy already exists it is updated. See create_object() for
+   * shared.
+   */
+  void clone_object(oksdbinterfaces::Configuration* confdb,
+                    const std::string& dbfile,
+                    const oksdbinterfaces::ConfigObject& src,
+                    const std::string& uid,
+                    oksdbinterfaces::ConfigObject& copy,
+                    bool shared = false);
+
+  /**
+   * Make a copy of src for use by any application, such as a variant
+   * of a configuration object named after its values. It goes in the
+   * GenerationPass's shared file, which every per-application file
+   * includes, rather than in the dbfile of the application that
+   * happens to need it first.
+   */
+  inline void clone_shared_object(oksdbinterfaces::Configuration* confdb,
+                                  const std::string& dbfile,
+                                  const oksdbinterfaces::ConfigObject& src,
+                                  const std::string& uid,
+                                  oksdbinterfaces::ConfigObject& copy) {
+    clone_object(confdb, GenerationPass::instance().shared_file(dbfile), src, uid, copy, true);
+  }
+
+  /**
+   * Return all objects directly referenced by obj through any of its
+   * relationships.
+   */
+  std::vector<oksdbinterfaces::ConfigObject>
+  referenced_objects(oksdbinterfaces::Configuration* confdb,
+                     const oksdbinterfaces::ConfigObject& obj);
+
+  /**
+   * The host part of a URI such as tcp://10.0.0.1:1234, empty if it
+   * has none
+   */
+  inline std::string uri_host(const std::string& uri) {
+    auto hostStart = uri.find("://");
+    if (hostStart == std::string::npos) {
+      return "";
+    }
+    hostStart += 3;
+    auto portStart = uri.rfind(':');
+    if (portStart < hostStart) {
+      portStart = std::string::npos;
+    }
+    return uri.substr(hostStart, portStart == std::string::npos ?
+                      std::string::npos : portStart - hostStart);
+  }
+
+  /**
+   * Bind a descriptor URI such as tcp://0.0.0.0:* to a specific
+   * interface: a wildcard host is replaced by ip (if not empty) and a
+   * wildcard port by port (if not 0).
+   */
+  inline std::string resolve_uri(const std::string& uri,
+                                 const std::string& ip,
+                                 uint16_t port) {
+    auto hostStart = uri.find("://");
+    if (hostStart == std::string::npos) {
+      return uri;
+    }
+    hostStart += 3;
+    auto portStart = uri.rfind(':');
+    if (portStart < hostStart) {
+      portStart = std::string::npos;
+    }
+    auto uriHost = uri_host(uri);
+    std::string uriPort = portStart == std::string::npos ? "" : uri.substr(portStart + 1);
+    if (!ip.empty() && (uriHost.empty() || uriHost == "0.0.0.0" || uriHost == "*")) {
+      uriHost = ip;
+    }
+    if (port != 0 && uriPort == "*") {
+      uriPort = std::to_string(port);
+    }
+    return uri.substr(0, hostStart) + uriHost + (uriPort.empty() ? "" : ":" + uriPort);
+  }
+
+  /**
+   * Set the port of a generated NetworkConnection bound on host (at
+   * ip) to the first port at or above base which is not used by
+   * another connection of the session on that host. The port the
+   * object had before (if it already existed) is kept when possible.
+   *
+   * The first time a host is seen, the ports of the NetworkConnections
+   * already in the database bound on ip (or on a wildcard address if
+   * ip is not known) are reserved, so that applications generated one
+   * at a time do not get the same ports.
+   */
+  inline uint16_t set_port(oksdbinterfaces::Configuration* confdb,
+                           oksdbinterfaces::ConfigObject& netObj,
+                           const coredal::Session* session,
+                           const std::string& host,
+                           const std::string& ip,
+                           uint16_t base) {
+    auto& allocator = PortAllocator::instance();
+    if (base != 0 && !allocator.has_host(session->UID(), host)) {
+      std::vector<oksdbinterfaces::ConfigObject> connections;
+      confdb->get("NetworkConnection", connections);
+      for (auto& conn : connections) {
+        std::string uri;
+        uint16_t port = 0;
+        conn.get("uri", uri);
+        conn.get("port", port);
+        auto connHost = uri_host(uri);
+        bool wildcard = connHost.empty() || connHost == "0.0.0.0" || connHost == "*";
+        if (ip.empty() ? wildcard : connHost == ip) {
+          allocator.reserve(session->UID(), host, conn.UID(), port);
+        }
+      }
+    }
+    uint16_t previous = 0;
+    netObj.get("port", previous);
+    auto port = allocator.allocate(session->UID(), host, netObj.UID(), base, previous);
+    netObj.set_by_val<uint16_t>("port", port);
+    return port;
+  }
+
+  /**
+   * Create (or update) the NetworkConnection uid as described by desc,
+   * bound on the given host and ip with a port from set_port(). See
+   * create_object() for shared.
+   */
+  inline void create_network_connection(oksdbinterfaces::Configuration* confdb,
+                                        const std::string& dbfile,
+                                        const std::string& uid,
+                                        const NetworkConnectionDescriptor* desc,
+                                        const coredal::Session* session,
+                                        const std::string& host,
+                                        const std::string& ip,
+                                        oksdbinterfaces::ConfigObject& netObj,
+                                        bool shared = false) {
+    create_object(confdb, dbfile, "NetworkConnection", uid, netObj, shared);
+    netObj.set_by_val<std::string>("data_type", desc->get_data_type());
+    netObj.set_by_val<std::string>("connection_type", desc->get_connection_type());
+    auto port = set_port(confdb, netObj, session, host, ip, desc->get_port());
+    netObj.set_by_val<std::string>("uri", resolve_uri(desc->get_uri(), ip, port));
+  }
+
+} // namespace dunedaq::readoutdal
+#endif // CONFUTILS_HPP
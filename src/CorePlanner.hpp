@@ -0,0 +1,296 @@
+/**
+ * @file CorePlanner.hpp
+ *
+ * Session wide allocation of disjoint sets of CPU cores to generated
+ * modules
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef COREPLANNER_HPP
+#define COREPLANNER_HPP
+
+#include "logging/Logging.hpp"
+#include "readoutdalIssues.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * Parse a core list as used by the DPDK -l option (e.g. "0-3,8,10-11")
+   */
+  inline std::vector<uint16_t> parse_core_list(const std::string& list) {
+    std::vector<uint16_t> cores;
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+      if (item.empty()) {
+        continue;
+      }
+      auto dash = item.find('-');
+      try {
+        if (dash == std::string::npos) {
+          cores.push_back(std::stoi(item));
+        }
+        else {
+          int first = std::stoi(item.substr(0, dash));
+          int last = std::stoi(item.substr(dash + 1));
+          for (int core = first; core <= last; core++) {
+            cores.push_back(core);
+          }
+        }
+      }
+      catch (const std::exception&) {
+        throw BadConf(ERS_HERE, "Bad core list '" + list + "'");
+      }
+    }
+    return cores;
+  }
+
+  inline std::string format_core_list(const std::vector<uint16_t>& cores) {
+    std::string list;
+    for (auto core : cores) {
+      list += (list.empty() ? "" : ",") + std::to_string(core);
+    }
+    return list;
+  }
+
+  /**
+   * Return the value following option (e.g. "-l") in an argument
+   * string, or an empty string if the option is not there
+   */
+  inline std::string get_option(const std::string& args, const std::string& option) {
+    std::istringstream stream(args);
+    std::string token;
+    while (stream >> token) {
+      if (token == option && stream >> token) {
+        return token;
+      }
+    }
+    return "";
+  }
+
+  /**
+   * Map the lcores of a -m value, one or more [main:workers].port
+   * groups separated by commas, to cores. A single group gets the
+   * first core as main and the others as workers; with several groups
+   * each takes as many of the cores, in turn, as it had before.
+   */
+  inline std::string set_lcore_map(const std::string& map,
+                                   const std::vector<uint16_t>& cores) {
+    struct Group {
+      size_t size;
+      std::string port;
+    };
+    std::vector<Group> groups;
+    size_t pos = 0;
+    while (pos < map.size()) {
+      auto close = map.find(']', pos);
+      if (map[pos] != '[' || close == std::string::npos) {
+        return map;
+      }
+      auto inside = map.substr(pos + 1, close - pos - 1);
+      auto colon = inside.find(':');
+      size_t size = 1;
+      if (colon != std::string::npos) {
+        size += parse_core_list(inside.substr(colon + 1)).size();
+      }
+      auto next = map.find(",[", close);
+      groups.push_back({size, map.substr(close + 1, next == std::string::npos ?
+                                         std::string::npos : next - close - 1)});
+      pos = next == std::string::npos ? map.size() : next + 1;
+    }
+    if (groups.size() == 1) {
+      groups[0].size = cores.size();
+    }
+
+    std::string result;
+    size_t index = 0;
+    for (auto& group : groups) {
+      std::vector<uint16_t> groupCores;
+      for (size_t n = 0; n < std::max<size_t>(group.size, 1); n++) {
+        groupCores.push_back(cores[index++ % cores.size()]);
+      }
+      std::vector<uint16_t> workers(groupCores.size() > 1 ? groupCores.begin() + 1 : groupCores.begin(),
+                                    groupCores.end());
+      result += (result.empty() ? "" : ",") + ("[" + std::to_string(groupCores[0]) + ":" +
+                                               format_core_list(workers) + "]" + group.port);
+    }
+    return result;
+  }
+
+  /**
+   * Rewrite DPDK EAL arguments to run on the given lcores: the -l
+   * list is replaced by cores and the lcore mapping of -m by
+   * set_lcore_map().
+   */
+  inline std::string set_eal_lcores(const std::string& args,
+                                    const std::vector<uint16_t>& cores) {
+    if (cores.empty()) {
+      return args;
+    }
+    std::istringstream stream(args);
+    std::ostringstream result;
+    std::string token;
+    std::string previous;
+    while (stream >> token) {
+      if (previous == "-l") {
+        token = format_core_list(cores);
+      }
+      else if (previous == "-m" && token.front() == '[') {
+        token = set_lcore_map(token, cores);
+      }
+      result << (previous.empty() ? "" : " ") << token;
+      previous = token;
+    }
+    return result.str();
+  }
+
+  /**
+   * Records which cores of each host have been given to which module
+   * in a Session, so that applications sharing a ProcessingResource
+   * on one host (it is not exclusive) do not get the same cores.
+   * Like the PortAllocator, assignments are keyed by module UID so
+   * that regenerating an application gives it its cores back.
+   */
+  class CoreAllocator {
+  public:
+    static CoreAllocator& instance() {
+      static CoreAllocator* allocator = new CoreAllocator(); // never deleted, like ModuleFactory
+      return *allocator;
+    }
+
+    /**
+     * Allocate n cores of pool, in order, to user on host, skipping
+     * those given to other users of session. The cores user had before
+     * are returned if there are still n of them in the pool. Returns
+     * an empty list if there are not enough free cores.
+     */
+    std::vector<uint16_t> allocate(const std::string& session,
+                                   const std::string& host,
+                                   const std::string& user,
+                                   const std::vector<uint16_t>& pool,
+                                   size_t n) {
+      std::unique_lock lock(m_mutex);
+      auto& cores = m_sessions[session][host];
+      auto it = cores.assigned.find(user);
+      if (it != cores.assigned.end()) {
+        auto& previous = it->second;
+        if (previous.size() == n &&
+            std::all_of(previous.begin(), previous.end(), [&pool](auto core) {
+              return std::find(pool.begin(), pool.end(), core) != pool.end();
+            })) {
+          return previous;
+        }
+        for (auto core : previous) {
+          cores.owner.erase(core);
+        }
+        cores.assigned.erase(it);
+      }
+      std::vector<uint16_t> result;
+      for (auto core : pool) {
+        if (result.size() == n) {
+          break;
+        }
+        if (cores.owner.count(core) == 0) {
+          result.push_back(core);
+        }
+      }
+      if (result.size() < n) {
+        return {};
+      }
+      for (auto core : result) {
+        cores.owner[core] = user;
+      }
+      cores.assigned[user] = result;
+      return result;
+    }
+
+    /// Number of the cores of pool on host not given to anyone in session
+    size_t free_cores(const std::string& session,
+                      const std::string& host,
+                      const std::vector<uint16_t>& pool) {
+      std::unique_lock lock(m_mutex);
+      auto& cores = m_sessions[session][host];
+      return std::count_if(pool.begin(), pool.end(), [&cores](auto core) {
+        return cores.owner.count(core) == 0;
+      });
+    }
+
+    /// Forget all the allocations made for session
+    void reset(const std::string& session) {
+      std::unique_lock lock(m_mutex);
+      m_sessions.erase(session);
+    }
+
+  private:
+    CoreAllocator() = default;
+
+    struct HostCores {
+      std::map<uint16_t, std::string> owner;
+      std::map<std::string, std::vector<uint16_t>> assigned;
+    };
+
+    std::mutex m_mutex;
+    std::map<std::string, std::map<std::string, HostCores>> m_sessions;
+  }; // CoreAllocator
+
+  /**
+   * Hands out the cores of one pool (e.g. the cores of a
+   * ProcessingResource) of a host through the CoreAllocator, so that
+   * no core is given to two modules of the session.
+   */
+  class CorePlanner {
+  public:
+    CorePlanner(const std::string& name, const std::string& session, const std::string& host,
+                const std::vector<uint16_t>& cores, const std::vector<uint16_t>& exclude = {}) :
+      m_name(name), m_session(session), m_host(host) {
+      for (auto core : cores) {
+        if (std::find(exclude.begin(), exclude.end(), core) == exclude.end() &&
+            std::find(m_cores.begin(), m_cores.end(), core) == m_cores.end()) {
+          m_cores.push_back(core);
+        }
+      }
+    }
+
+    /// True if the pool was configured with any cores at all
+    bool enabled() const { return !m_cores.empty(); }
+
+    /**
+     * Allocate n cores to user. If the pool is exhausted a warning is
+     * issued and an empty list returned.
+     */
+    std::vector<uint16_t> allocate(size_t n, const std::string& user) {
+      auto& allocator = CoreAllocator::instance();
+      auto cores = allocator.allocate(m_session, m_host, user, m_cores, n);
+      if (cores.size() < n) {
+        ers::warning(ResourceShortage(ERS_HERE, m_name,
+                                      "cannot allocate " + std::to_string(n) + " cores to " +
+                                      user + ", only " +
+                                      std::to_string(allocator.free_cores(m_session, m_host, m_cores)) +
+                                      " left"));
+        return cores;
+      }
+      TLOG_DEBUG(11) << "Cores " << format_core_list(cores) << " of " << m_name
+                     << " allocated to " << user;
+      return cores;
+    }
+
+  private:
+    std::string m_name;
+    std::string m_session;
+    std::string m_host;
+    std::vector<uint16_t> m_cores;
+  }; // CorePlanner
+
+} // namespace dunedaq::readoutdal
+#endif // COREPLANNER_HPP
@@ -8,20 +8,35 @@
  * received with this code.
  */
 
+#include "ConfUtils.hpp"
 #include "ModuleFactory.hpp"
+#include "QueuePlanner.hpp"
+#include "ReadoutSources.hpp"
+#include "StorageModel.hpp"
 
 #include "oksdbinterfaces/Configuration.hpp"
 #include "oks/kernel.hpp"
 #include "coredal/Connection.hpp"
+#include "coredal/DaqModule.hpp"
 #include "coredal/NetworkConnection.hpp"
+#include "coredal/StorageDevice.hpp"
+#include "readoutdal/DataWriter.hpp"
+#include "readoutdal/DataStoreConf.hpp"
+#include "readoutdal/DataWriterConf.hpp"
 #include "readoutdal/DFApplication.hpp"
+#include "readoutdal/DFHWConf.hpp"
+#include "readoutdal/DFOApplication.hpp"
 #include "readoutdal/NetworkConnectionRule.hpp"
 #include "readoutdal/NetworkConnectionDescriptor.hpp"
 #include "readoutdal/QueueConnectionRule.hpp"
 #include "readoutdal/QueueDescriptor.hpp"
+#include "readoutdal/SessionUtils.hpp"
+#include "readoutdal/TRBConf.hpp"
+#include "readoutdal/TRBuilder.hpp"
 #include "readoutdalIssues.hpp"
 #include "logging/Logging.hpp"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -39,6 +54,59 @@ __reg__("DFApplication", [] (const SmartDaqApplication* smartApp,
   }
   );
 
+namespace {
+
+  /**
+   * Add the network inputs of the module uid (the data request
+   * connections of a DLH or TPHandler) to connections, warning if the
+   * module has not been generated
+   */
+  void add_request_connections(oksdbinterfaces::Configuration* confdb,
+                               const std::string& uid,
+                               const std::string& user,
+                               std::vector<oksdbinterfaces::ConfigObject>& connections) {
+    auto module = confdb->get<coredal::DaqModule>(uid);
+    if (module == nullptr) {
+      ers::warning(BadConf(ERS_HERE, "No module " + uid + " to send data requests to, generate it before " +
+                           user));
+      return;
+    }
+    for (auto con : module->get_inputs()) {
+      if (con->cast<coredal::NetworkConnection>()) {
+        connections.push_back(con->config_object());
+      }
+    }
+  }
+
+  /**
+   * The data request inputs of the DLHs and TPHandlers that the
+   * ReadoutApplications of the session generated
+   * (generate_session_modules() generates them before the
+   * DFApplications)
+   */
+  std::vector<oksdbinterfaces::ConfigObject>
+  request_connections(oksdbinterfaces::Configuration* confdb,
+                      const coredal::Session* session,
+                      const std::string& user) {
+    std::vector<oksdbinterfaces::ConfigObject> connections;
+    for (auto app : get_smart_applications(session)) {
+      auto roApp = app->cast<ReadoutApplication>();
+      if (roApp == nullptr) {
+        continue;
+      }
+      for (auto stream : enabled_streams(roApp, session)) {
+        add_request_connections(confdb, "DLH-" + std::to_string(stream->get_src_id()),
+                                user, connections);
+      }
+      for (auto id : tp_handler_ids(roApp, session)) {
+        add_request_connections(confdb, "tphandler-" + std::to_string(id), user, connections);
+      }
+    }
+    return connections;
+  }
+
+} // namespace
+
 std::vector<const coredal::DaqModule*> 
 DFApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
                                      const std::string& dbfile,
@@ -46,8 +114,139 @@ DFApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
 {
   std::vector<const coredal::DaqModule*> modules;
 
-  // Code to actually generate modules should go here
-  std::cout << __FUNCTION__ << " -- Unimplemented function\n";
+  auto host = application_host(this);
+  auto dataIp = application_data_ip(this);
+
+  auto trbConf = get_trb();
+  auto dwrConf = get_data_writer();
+  if (trbConf == nullptr || dwrConf == nullptr) {
+    throw (BadConf(ERS_HERE, "No TRBuilder or DataWriter configuration given"));
+  }
+  validate_file_layout(dwrConf->get_data_store_params()->get_file_layout_params());
+  if (dwrConf->get_write_mode() == "asynchronous") {
+    if (dwrConf->get_write_buffers() < 2 || dwrConf->get_write_buffer_size() == 0) {
+      throw (BadConf(ERS_HERE, "DataWriterConf " + dwrConf->UID() +
+                     " needs at least 2 non-empty write buffers in asynchronous mode"));
+    }
+    TLOG_DEBUG(7) << "DataWriters of " << UID() << " use " << dwrConf->get_write_buffers()
+                  << " buffers of " << dwrConf->get_write_buffer_size() << " bytes";
+  }
+  if (get_uses() == nullptr || get_uses()->get_uses().empty()) {
+    throw (BadConf(ERS_HERE, "No StorageDevice given for the DataWriters"));
+  }
+  auto storageDevices = get_uses()->get_uses();
+
+  // Process the queue rules looking for the input to our DataWriters
+  const QueueDescriptor* dwrInputQDesc = nullptr;
+  for (auto rule : get_queue_rules()) {
+    if (rule->get_destination_class() == "DataWriter") {
+      dwrInputQDesc = rule->get_descriptor();
+    }
+  }
+  if (dwrInputQDesc == nullptr) {
+    throw (BadConf(ERS_HERE, "No DataWriter input queue descriptor given"));
+  }
+
+  // Process the network rules looking for the TRBuilder inputs (trigger
+  // decisions and fragments) and the tokens returned to the DFO
+  std::vector<const NetworkConnectionDescriptor*> trbNetDescs;
+  const NetworkConnectionDescriptor* tokenNetDesc = nullptr;
+  for (auto rule : get_network_rules()) {
+    auto endpoint_class = rule->get_endpoint_class();
+    if (endpoint_class == "TRBuilder") {
+      trbNetDescs.push_back(rule->get_descriptor());
+    }
+    else if (endpoint_class == "DFOModule") {
+      tokenNetDesc = rule->get_descriptor();
+    }
+  }
+
+  // The DataWriters send their tokens to the DFO of the session, so
+  // the connection is bound where that runs
+  oksdbinterfaces::ConfigObject tokenNetObj;
+  if (tokenNetDesc) {
+    for (auto app : get_smart_applications(session)) {
+      if (auto dfoApp = app->cast<DFOApplication>()) {
+        create_network_connection(confdb, GenerationPass::instance().shared_file(dbfile),
+                                  tokenNetDesc->get_uid_base(), tokenNetDesc,
+                                  session, application_host(dfoApp),
+                                  application_data_ip(dfoApp), tokenNetObj, true);
+        break;
+      }
+    }
+    if (tokenNetObj.is_null()) {
+      ers::warning(BadConf(ERS_HERE, "No DFOApplication in session " + session->UID() +
+                           " to return DataWriter tokens to"));
+    }
+  }
+
+  // All the DataWriters take trigger records from one queue so that
+  // each record goes to whichever writer (and storage device) is free
+  uint32_t nTRBs = std::max<uint32_t>(1, get_trb_instances());
+  std::string queueUid("inputToDataWriter-" + UID());
+  oksdbinterfaces::ConfigObject queueObj;
+  create_queue(confdb, dbfile, queueUid, dwrInputQDesc, nTRBs, storageDevices.size(), 0, queueObj);
+
+  // The TRBuilders all use the same configuration and split the
+  // trigger decisions between them by trigger number. Each has its own
+  // set of network inputs (e.g. trigger decisions and fragments),
+  // which go in the shared file as the DFO also uses them. They all
+  // send data requests to every DLH and TPHandler of the session.
+  auto requestObjs = request_connections(confdb, session, UID());
+  auto trbConfObj = trbConf->config_object();
+  for (uint32_t shard = 0; shard < nTRBs; shard++) {
+    std::string suffix(nTRBs > 1 ? "-" + std::to_string(shard) : "");
+    std::vector<oksdbinterfaces::ConfigObject> trbNetObjs;
+    for (auto desc : trbNetDescs) {
+      std::string netUid(desc->get_uid_base() + std::to_string(get_src_id()) + suffix);
+      trbNetObjs.emplace_back();
+      create_network_connection(confdb, GenerationPass::instance().shared_file(dbfile),
+                                netUid, desc, session, host, dataIp, trbNetObjs.back());
+    }
+    std::vector<const oksdbinterfaces::ConfigObject*> trbInputs;
+    for (auto& netObj : trbNetObjs) {
+      trbInputs.push_back(&netObj);
+    }
+
+    std::string trbUid("trb-" + UID() + suffix);
+    oksdbinterfaces::ConfigObject trbObj;
+    create_object(confdb, dbfile, "TRBuilder", trbUid, trbObj);
+    trbObj.set_by_val<uint32_t>("trigger_number_modulo", nTRBs);
+    trbObj.set_by_val<uint32_t>("trigger_number_index", shard);
+    trbObj.set_obj("configuration", &trbConfObj);
+    trbObj.set_objs("inputs", trbInputs);
+    std::vector<const oksdbinterfaces::ConfigObject*> trbOutputs{&queueObj};
+    for (auto& netObj : requestObjs) {
+      trbOutputs.push_back(&netObj);
+    }
+    trbObj.set_objs("outputs", trbOutputs);
+    modules.push_back(confdb->get<TRBuilder>(trbUid));
+  }
+
+  // One DataWriter per storage device
+  auto dwrConfObj = dwrConf->config_object();
+  int wnum = 0;
+  for (auto device : storageDevices) {
+    std::string dwrUid("datawriter-" + UID() + "-" + std::to_string(wnum++));
+    oksdbinterfaces::ConfigObject dwrObj;
+    create_object(confdb, dbfile, "DataWriter", dwrUid, dwrObj);
+    // Fit the file alignment and size to the device
+    auto confObj = dwrConfObj;
+    oksdbinterfaces::ConfigObject storeObj;
+    if (store_variant(confdb, dbfile, dwrConf->get_data_store_params(), device, 1, storeObj)) {
+      clone_shared_object(confdb, dbfile, dwrConfObj,
+                          dwrConf->UID() + "-" + storeObj.UID(), confObj);
+      confObj.set_obj("data_store_params", &storeObj);
+    }
+    dwrObj.set_obj("configuration", &confObj);
+    auto deviceObj = device->config_object();
+    dwrObj.set_obj("storage", &deviceObj);
+    dwrObj.set_objs("inputs", {&queueObj});
+    if (!tokenNetObj.is_null()) {
+      dwrObj.set_objs("outputs", {&tokenNetObj});
+    }
+    modules.push_back(confdb->get<DataWriter>(dwrUid));
+  }
 
   return modules;
 }
@@ -1,5 +1,5 @@
 /**
- * @file DFO.cpp
+ * @file DFOApplication.cpp
  *
  * Implementation of DFOApplication's generate_modules dal method
  *
@@ -8,20 +8,29 @@
  * received with this code.
  */
 
+#include "ConfUtils.hpp"
 #include "ModuleFactory.hpp"
+#include "QueuePlanner.hpp"
 
 #include "oksdbinterfaces/Configuration.hpp"
 #include "oks/kernel.hpp"
 #include "coredal/Connection.hpp"
 #include "coredal/NetworkConnection.hpp"
+#include "readoutdal/DFApplication.hpp"
+#include "readoutdal/DFHWConf.hpp"
 #include "readoutdal/DFOApplication.hpp"
+#include "readoutdal/DFOConf.hpp"
+#include "readoutdal/DFOModule.hpp"
 #include "readoutdal/NetworkConnectionRule.hpp"
 #include "readoutdal/NetworkConnectionDescriptor.hpp"
 #include "readoutdal/QueueConnectionRule.hpp"
 #include "readoutdal/QueueDescriptor.hpp"
+#include "readoutdal/SessionUtils.hpp"
 #include "readoutdalIssues.hpp"
 #include "logging/Logging.hpp"
 
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -46,8 +55,105 @@ DFOApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
 {
   std::vector<const coredal::DaqModule*> modules;
 
-  // Code to actually generate modules should go here
-  std::cout << __FUNCTION__ << " -- Unimplemented function\n";
+  auto dfoConf = get_dfo();
+  if (dfoConf == nullptr) {
+    throw (BadConf(ERS_HERE, "No DFO configuration given"));
+  }
+  auto host = application_host(this);
+  auto dataIp = application_data_ip(this);
+
+  // Our own network inputs (e.g. tokens from the DataWriters and
+  // trigger decisions) are bound here. They are shared with the
+  // DFApplications, which return their tokens through them.
+  std::vector<oksdbinterfaces::ConfigObject> inputObjs;
+  std::vector<const NetworkConnectionDescriptor*> trbNetDescs;
+  for (auto rule : get_network_rules()) {
+    auto endpoint_class = rule->get_endpoint_class();
+    auto desc = rule->get_descriptor();
+    if (endpoint_class == "DFOModule") {
+      inputObjs.emplace_back();
+      create_network_connection(confdb, GenerationPass::instance().shared_file(dbfile),
+                                desc->get_uid_base(), desc, session, host, dataIp,
+                                inputObjs.back(), true);
+    }
+    else if (endpoint_class == "TRBuilder") {
+      trbNetDescs.push_back(desc);
+    }
+  }
+
+  // Connect to every TRBuilder of every DFApplication in the session
+  // through the connections DFApplication::generate_modules() made for
+  // the rules we have for TRBuilder (generate_session_modules()
+  // generates the DFApplications first). Note how many trigger
+  // decisions each application can hold.
+  std::vector<oksdbinterfaces::ConfigObject> outputObjs;
+  uint32_t dfCapacity = std::numeric_limits<uint32_t>::max();
+  for (auto app : get_smart_applications(session)) {
+    auto dfApp = app->cast<DFApplication>();
+    if (dfApp == nullptr) {
+      continue;
+    }
+    uint32_t nTRBs = std::max<uint32_t>(1, dfApp->get_trb_instances());
+    for (uint32_t shard = 0; shard < nTRBs; shard++) {
+      std::string suffix(nTRBs > 1 ? "-" + std::to_string(shard) : "");
+      for (auto desc : trbNetDescs) {
+        std::string netUid(desc->get_uid_base() + std::to_string(dfApp->get_src_id()) + suffix);
+        if (!confdb->test_object("NetworkConnection", netUid)) {
+          ers::warning(BadConf(ERS_HERE, "No connection " + netUid + " to a TRBuilder of " +
+                               dfApp->UID() + ", generate it before " + UID()));
+          continue;
+        }
+        outputObjs.emplace_back();
+        confdb->get("NetworkConnection", netUid, outputObjs.back());
+      }
+    }
+    // A record in the making in each TRBuilder plus those waiting in
+    // the DataWriter input queue
+    size_t nWriters = dfApp->get_uses() ? dfApp->get_uses()->get_uses().size() : 1;
+    for (auto rule : dfApp->get_queue_rules()) {
+      if (rule->get_destination_class() == "DataWriter") {
+        auto qDesc = rule->get_descriptor();
+        dfCapacity = std::min(dfCapacity,
+                              nTRBs + queue_capacity(qDesc, nTRBs, 0) +
+                              static_cast<uint32_t>(nWriters));
+      }
+    }
+  }
+  if (outputObjs.empty()) {
+    ers::warning(BadConf(ERS_HERE, "No TRBuilder connections for DFO " + UID()));
+  }
+
+  // Derive the busy/free thresholds from what the smallest
+  // DFApplication can hold, keeping the default 2:1 ratio
+  auto dfoConfObj = dfoConf->config_object();
+  if (get_auto_thresholds() && dfCapacity != std::numeric_limits<uint32_t>::max()) {
+    int32_t busy = static_cast<int32_t>(std::min<uint32_t>(
+      dfCapacity, std::numeric_limits<int32_t>::max()));
+    int32_t freeThreshold = std::max(1, busy / 2);
+    if (busy != dfoConf->get_busy_threshold() || freeThreshold != dfoConf->get_free_threshold()) {
+      std::string confUid(dfoConf->UID() + "-" + UID());
+      clone_object(confdb, dbfile, dfoConf->config_object(), confUid, dfoConfObj);
+      dfoConfObj.set_by_val<int32_t>("busy_threshold", busy);
+      dfoConfObj.set_by_val<int32_t>("free_threshold", freeThreshold);
+      TLOG_DEBUG(7) << "DFO thresholds busy=" << busy << " free=" << freeThreshold;
+    }
+  }
+
+  std::vector<const oksdbinterfaces::ConfigObject*> inputs;
+  for (auto& obj : inputObjs) {
+    inputs.push_back(&obj);
+  }
+  std::vector<const oksdbinterfaces::ConfigObject*> outputs;
+  for (auto& obj : outputObjs) {
+    outputs.push_back(&obj);
+  }
+  std::string dfoUid("dfo-" + UID());
+  oksdbinterfaces::ConfigObject dfoObj;
+  create_object(confdb, dbfile, "DFOModule", dfoUid, dfoObj);
+  dfoObj.set_obj("configuration", &dfoConfObj);
+  dfoObj.set_objs("inputs", inputs);
+  dfoObj.set_objs("outputs", outputs);
+  modules.push_back(confdb->get<DFOModule>(dfoUid));
 
   return modules;
 }
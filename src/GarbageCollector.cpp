@@ -0,0 +1,307 @@
+/**
+ * @file GarbageCollector.cpp
+ *
+ * Implementation of the removal of stale generated objects
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "readoutdal/GarbageCollector.hpp"
+#include "readoutdal/SessionUtils.hpp"
+
+#include "ConfUtils.hpp"
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+#include "oksdbinterfaces/Schema.hpp"
+
+#include "coredal/Connection.hpp"
+#include "coredal/DaqModule.hpp"
+#include "coredal/Session.hpp"
+
+#include "readoutdal/NetworkConnectionDescriptor.hpp"
+#include "readoutdal/SmartDaqApplication.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <regex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace dunedaq;
+using namespace dunedaq::readoutdal;
+
+static std::string
+object_key(const std::string& class_name, const std::string& uid) {
+  return uid + "@" + class_name;
+}
+
+static bool
+in_files(const std::string& file, const std::vector<std::string>& dbfiles) {
+  auto path = std::filesystem::weakly_canonical(file);
+  for (auto& dbfile : dbfiles) {
+    if (path == std::filesystem::weakly_canonical(dbfile)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+namespace {
+
+/**
+ * The UIDs of the modules, queues and NetworkConnections that the
+ * generators create, and the parts of the database their other UIDs
+ * are built from
+ */
+struct GeneratedNames {
+  std::vector<std::string> modulePrefixes{"DLH-", "tphandler-", "datareader-", "trb-",
+                                          "datawriter-", "dfo-", "tpwriter-"};
+  std::vector<std::string> queuePrefixes{"inputToDLH-", "inputToTPH-", "inputToDataWriter-"};
+  std::vector<std::string> connectionPrefixes{"ReqToTPH-"};
+  std::set<std::string> applications;
+
+  explicit GeneratedNames(oksdbinterfaces::Configuration* confdb) {
+    std::vector<const NetworkConnectionDescriptor*> descs;
+    confdb->get<NetworkConnectionDescriptor>(descs);
+    for (auto desc : descs) {
+      if (!desc->get_uid_base().empty()) {
+        connectionPrefixes.push_back(desc->get_uid_base());
+      }
+    }
+    std::vector<const SmartDaqApplication*> apps;
+    confdb->get<SmartDaqApplication>(apps);
+    for (auto app : apps) {
+      applications.insert(app->UID());
+    }
+  }
+};
+
+} // namespace
+
+static bool
+has_prefix(const std::string& uid, const std::vector<std::string>& prefixes) {
+  for (auto& prefix : prefixes) {
+    if (uid.compare(0, prefix.size(), prefix) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Whether uid of class_name is named like a copy the generators make
+ * of another object of the class: the value-named variants of
+ * link_handler_variant() and store_variant(), the per-application
+ * copies of the DFO and TPWriter configurations, and the DataWriterConf
+ * copies named after their DataStoreConf variant
+ */
+static bool
+is_generated_copy(oksdbinterfaces::Configuration* confdb,
+                  const std::string& class_name,
+                  const std::string& uid,
+                  const GeneratedNames& names) {
+  static const std::regex lhVariant("(-numa\\d+)?(-lb\\d+)?(-al\\d+)?(-sb\\d+)?");
+  static const std::regex storeVariant("(-align\\d+)?(-max\\d+)?");
+  static const std::regex slice("-\\d+");
+  for (auto pos = uid.find('-', 1); pos != std::string::npos; pos = uid.find('-', pos + 1)) {
+    auto base = uid.substr(0, pos);
+    auto suffix = uid.substr(pos);
+    if (!confdb->test_object(class_name, base)) {
+      continue;
+    }
+    if (std::regex_match(suffix, lhVariant) || std::regex_match(suffix, storeVariant)) {
+      return true;
+    }
+    for (auto& app : names.applications) {
+      if (suffix.compare(1, std::string::npos, app) == 0 ||
+          (suffix.compare(1, app.size(), app) == 0 &&
+           std::regex_match(suffix.substr(app.size() + 1), slice))) {
+        return true;
+      }
+    }
+    auto store = suffix.substr(1);
+    if (class_name == "DataWriterConf" && confdb->test_object("DataStoreConf", store) &&
+        is_generated_copy(confdb, "DataStoreConf", store, names)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Whether obj is one of the objects the generators create. Objects
+ * written by users (streams, configurations...) never are, even if
+ * they are in one of the files being cleaned or only stale objects
+ * refer to them.
+ */
+static bool
+is_generated(oksdbinterfaces::Configuration* confdb,
+             const oksdbinterfaces::ConfigObject& obj,
+             const GeneratedNames& names) {
+  auto uid = obj.UID();
+  auto class_name = obj.class_name();
+  const auto& cinfo = confdb->get_class_info(class_name);
+  auto is_a = [&](const std::string& base) {
+    return class_name == base ||
+      std::find(cinfo.p_superclasses.begin(), cinfo.p_superclasses.end(), base) !=
+      cinfo.p_superclasses.end();
+  };
+  if (is_a("DaqModule")) {
+    return has_prefix(uid, names.modulePrefixes);
+  }
+  if (is_a("Queue")) {
+    return has_prefix(uid, names.queuePrefixes);
+  }
+  if (is_a("NetworkConnection")) {
+    return has_prefix(uid, names.connectionPrefixes);
+  }
+  if (is_a("DataReaderConf") && has_prefix(uid, {"datareader-"}) &&
+      uid.size() > 5 && uid.compare(uid.size() - 5, 5, "-conf") == 0) {
+    return true;
+  }
+  return is_generated_copy(confdb, class_name, uid, names);
+}
+
+static void
+release_composites(oksdbinterfaces::Configuration* confdb,
+                   oksdbinterfaces::ConfigObject& obj) {
+  const auto& cinfo = confdb->get_class_info(obj.class_name());
+  for (const auto& rel : cinfo.p_relationships) {
+    if (!rel.p_is_aggregation) {
+      continue;
+    }
+    if (rel.p_cardinality == oksdbinterfaces::zero_or_many ||
+        rel.p_cardinality == oksdbinterfaces::one_or_many) {
+      obj.set_objs(rel.p_name, {}, true);
+    }
+    else {
+      obj.set_obj(rel.p_name, nullptr, true);
+    }
+  }
+}
+
+std::vector<std::string>
+dunedaq::readoutdal::remove_stale_objects(oksdbinterfaces::Configuration* confdb,
+                                          const std::vector<std::string>& dbfiles,
+                                          const std::vector<const coredal::DaqModule*>& live,
+                                          bool dry_run) {
+  std::set<std::string> liveKeys;
+  for (auto module : live) {
+    liveKeys.insert(object_key(module->class_name(), module->UID()));
+    for (auto con : module->get_inputs()) {
+      liveKeys.insert(object_key(con->class_name(), con->UID()));
+    }
+    for (auto con : module->get_outputs()) {
+      liveKeys.insert(object_key(con->class_name(), con->UID()));
+    }
+  }
+
+  GeneratedNames names(confdb);
+
+  // Find generated objects in our files that nobody is using any more
+  std::set<std::string> staleKeys;
+  std::vector<oksdbinterfaces::ConfigObject> stale;
+  auto add_unused = [&](const std::string& class_name) {
+    std::vector<oksdbinterfaces::ConfigObject> objs;
+    confdb->get(class_name, objs);
+    for (auto& obj : objs) {
+      auto key = object_key(obj.class_name(), obj.UID());
+      if (staleKeys.count(key) || liveKeys.count(key) ||
+          !in_files(obj.contained_in(), dbfiles) || !is_generated(confdb, obj, names)) {
+        continue;
+      }
+      std::vector<oksdbinterfaces::ConfigObject> referrers;
+      obj.referenced_by(referrers, "*", false);
+      if (referrers.empty()) {
+        staleKeys.insert(key);
+        stale.push_back(obj);
+      }
+    }
+  };
+  // Modules are never referenced once the applications generate them,
+  // other objects are stale if nothing refers to them any more (e.g.
+  // the configuration variant of a DLH which now uses another one)
+  add_unused("DaqModule");
+  for (auto class_name : {"Queue", "NetworkConnection", "LinkHandlerConf", "LatencyBuffer",
+                          "DataReaderConf", "DataStoreConf", "DataWriterConf", "DFOConf",
+                          "TPWriterConf", "FilenameParams"}) {
+    add_unused(class_name);
+  }
+
+  // Then any generated object in our files (connections, per-stream
+  // configuration variants...) which is only used by stale objects.
+  // The user objects they refer to, such as the streams of a stale
+  // NICReceiver, are left alone.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    std::vector<oksdbinterfaces::ConfigObject> candidates;
+    for (auto& obj : stale) {
+      for (auto& ref : referenced_objects(confdb, obj)) {
+        candidates.push_back(ref);
+      }
+    }
+    for (auto& obj : candidates) {
+      auto key = object_key(obj.class_name(), obj.UID());
+      if (staleKeys.count(key) || liveKeys.count(key) ||
+          !in_files(obj.contained_in(), dbfiles) || !is_generated(confdb, obj, names)) {
+        continue;
+      }
+      std::vector<oksdbinterfaces::ConfigObject> referrers;
+      obj.referenced_by(referrers, "*", false);
+      bool used = false;
+      for (auto& ref : referrers) {
+        if (staleKeys.count(object_key(ref.class_name(), ref.UID())) == 0) {
+          used = true;
+          break;
+        }
+      }
+      if (!used) {
+        staleKeys.insert(key);
+        stale.push_back(obj);
+        changed = true;
+      }
+    }
+  }
+
+  std::vector<std::string> removed;
+  for (auto& obj : stale) {
+    TLOG_DEBUG(7) << (dry_run ? "Would remove " : "Removing ")
+                  << "stale object " << obj.UID() << "@" << obj.class_name();
+    removed.push_back(obj.UID());
+    if (!dry_run) {
+      // Generated objects may hold user objects through composite
+      // relationships (e.g. the streams of a NICReceiver), which OKS
+      // could destroy along with them
+      release_composites(confdb, obj);
+      confdb->destroy_obj(obj);
+    }
+  }
+  return removed;
+}
+
+std::vector<std::string>
+dunedaq::readoutdal::collect_garbage(oksdbinterfaces::Configuration* confdb,
+                                     const std::string& dbfile,
+                                     const coredal::Session* session,
+                                     bool dry_run,
+                                     bool per_app_files) {
+  std::vector<std::string> dbfiles{dbfile};
+  std::vector<const coredal::DaqModule*> live;
+  for (auto& gen : generate_session_modules(confdb, dbfile, session, per_app_files)) {
+    live.insert(live.end(), gen.modules.begin(), gen.modules.end());
+    if (gen.dbfile != dbfile) {
+      dbfiles.push_back(gen.dbfile);
+    }
+  }
+  if (per_app_files) {
+    dbfiles.push_back(shared_dbfile(confdb, dbfile));
+  }
+  return remove_stale_objects(confdb, dbfiles, live, dry_run);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file GenerationPass.hpp
+ *
+ * Record of which application generated each object during one
+ * generate_session_modules() pass, and of where objects shared by
+ * applications go
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef GENERATIONPASS_HPP
+#define GENERATIONPASS_HPP
+
+#include "readoutdalIssues.hpp"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * While a pass is running, every object generated for one
+   * application is claimed by it, so that a second application
+   * generating an object with the same class and UID (e.g. two
+   * ReadoutApplications with the same stream source ID) is an error
+   * rather than silently taking the object over. Outside a pass (when
+   * a single application is generated) nothing is checked.
+   */
+  class GenerationPass {
+  public:
+    static GenerationPass& instance() {
+      static GenerationPass* pass = new GenerationPass(); // never deleted, like ModuleFactory
+      return *pass;
+    }
+
+    /// Start a pass, forgetting the objects claimed in any earlier one
+    void begin() {
+      std::unique_lock lock(m_mutex);
+      m_active = true;
+      m_application.clear();
+      m_sharedFile.clear();
+      m_owners.clear();
+    }
+
+    /// Objects created from now on are generated for application
+    void set_application(const std::string& application) {
+      std::unique_lock lock(m_mutex);
+      m_application = application;
+    }
+
+    void end() {
+      std::unique_lock lock(m_mutex);
+      m_active = false;
+      m_application.clear();
+      m_sharedFile.clear();
+      m_owners.clear();
+    }
+
+    /**
+     * Claim the object for the current application, throwing BadConf
+     * if another application of the pass has already claimed it
+     */
+    void claim(const std::string& class_name, const std::string& uid) {
+      std::unique_lock lock(m_mutex);
+      if (!m_active || m_application.empty()) {
+        return;
+      }
+      auto [it, inserted] = m_owners.emplace(std::make_pair(class_name, uid), m_application);
+      if (!inserted && it->second != m_application) {
+        throw BadConf(ERS_HERE, class_name + " " + uid + " is generated by both " +
+                      it->second + " and " + m_application);
+      }
+    }
+
+    /**
+     * Use file for objects shared between applications (see
+     * shared_dbfile()), or dbfile itself if file is empty
+     */
+    void set_shared_file(const std::string& file) {
+      std::unique_lock lock(m_mutex);
+      m_sharedFile = file;
+    }
+
+    /// The file for shared objects of an application generated in dbfile
+    std::string shared_file(const std::string& dbfile) {
+      std::unique_lock lock(m_mutex);
+      return m_sharedFile.empty() ? dbfile : m_sharedFile;
+    }
+
+  private:
+    GenerationPass() = default;
+
+    std::mutex m_mutex;
+    bool m_active = false;
+    std::string m_application;
+    std::string m_sharedFile;
+    std::map<std::pair<std::string, std::string>, std::string> m_owners;
+  }; // GenerationPass
+
+} // namespace dunedaq::readoutdal
+#endif // GENERATIONPASS_HPP
@@ -0,0 +1,89 @@
+/**
+ * @file MemoryModel.hpp
+ *
+ * Memory needed by the latency buffers of generated modules
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef MEMORYMODEL_HPP
+#define MEMORYMODEL_HPP
+
+#include "readoutdal/DataReaderConf.hpp"
+#include "readoutdal/LatencyBuffer.hpp"
+#include "readoutdal/NICReceiverConf.hpp"
+#include "readoutdal/NICStatsConf.hpp"
+#include "readoutdal/ReadoutHost.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * Size in bytes of one slot of lb: its element_size, else the
+   * expected packet size of the reader, else 0 (unknown)
+   */
+  inline uint64_t buffer_element_size(const LatencyBuffer* lb,
+                                      const DataReaderConf* rdrConf) {
+    if (lb->get_element_size() > 0) {
+      return lb->get_element_size();
+    }
+    auto nicConf = rdrConf ? rdrConf->cast<NICReceiverConf>() : nullptr;
+    if (nicConf && nicConf->get_stats_conf()) {
+      return nicConf->get_stats_conf()->get_expected_packet_size();
+    }
+    return 0;
+  }
+
+  /**
+   * Number of slots needed to keep timeout_ms worth of packets
+   * arriving at rate_hz, plus the buffer's size margin. Returns the
+   * configured size if the rate is not known.
+   */
+  inline uint32_t latency_buffer_slots(const LatencyBuffer* lb,
+                                       double rate_hz,
+                                       uint32_t timeout_ms) {
+    if (rate_hz <= 0) {
+      return lb->get_size();
+    }
+    auto slots = std::ceil(rate_hz * timeout_ms / 1000.0 *
+                           (1.0 + lb->get_size_margin_percent() / 100.0));
+    return static_cast<uint32_t>(std::min(std::max(slots, 1.0), double(UINT32_MAX)));
+  }
+
+  /**
+   * Bytes of memory taken by slots elements of element_size, rounded
+   * up to whole hugepages of the host if the buffer uses the intrinsic
+   * (hugepage backed) allocator.
+   */
+  inline uint64_t latency_buffer_bytes(const LatencyBuffer* lb,
+                                       uint64_t slots,
+                                       uint64_t element_size,
+                                       const ReadoutHost* host) {
+    uint64_t bytes = slots * element_size;
+    if (lb->get_intrinsic_allocator() && host && host->get_hugepage_size_kb() > 0) {
+      uint64_t page = uint64_t(host->get_hugepage_size_kb()) * 1024;
+      bytes = (bytes + page - 1) / page * page;
+    }
+    return bytes;
+  }
+
+  /**
+   * Size in bytes of the memory pages of host, its hugepages if
+   * hugepages is set. The usual x86 sizes are assumed if host is not a
+   * ReadoutHost.
+   */
+  inline uint32_t host_page_size(const ReadoutHost* host, bool hugepages) {
+    uint32_t kb = hugepages ? 2048 : 4;
+    if (host) {
+      kb = hugepages ? host->get_hugepage_size_kb() : host->get_page_size_kb();
+    }
+    return kb * 1024;
+  }
+
+} // namespace dunedaq::readoutdal
+#endif // MEMORYMODEL_HPP
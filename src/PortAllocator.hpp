@@ -0,0 +1,138 @@
+/**
+ * @file PortAllocator.hpp
+ *
+ * Session wide allocation of the network ports of generated
+ * NetworkConnections
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef PORTALLOCATOR_HPP
+#define PORTALLOCATOR_HPP
+
+#include "logging/Logging.hpp"
+#include "readoutdalIssues.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * Hands out ports so that no two generated NetworkConnections of
+   * the same Session bind the same port on the same host, whichever
+   * application generated them. Allocations are keyed by connection
+   * UID so regenerating an application returns the ports it was given
+   * before. Ports of connections already in the database can be
+   * reserved first so that generating one application at a time
+   * does not reuse them; a reserved port is only given back to the
+   * connection that had it, and only if it is still at or above the
+   * base the connection asks for.
+   */
+  class PortAllocator {
+  public:
+    static PortAllocator& instance() {
+      static PortAllocator* allocator = new PortAllocator(); // never deleted, like ModuleFactory
+      return *allocator;
+    }
+
+    /**
+     * Allocate a port for connection on host.
+     *
+     * @param session    UID of the Session the connection belongs to
+     * @param host       Host the connection is bound on
+     * @param connection UID of the NetworkConnection
+     * @param base       First port to try. 0 means an ephemeral port
+     *                   and is returned unchanged.
+     * @param preferred  Port the connection had previously (e.g. in an
+     *                   existing database), used if still free
+     */
+    uint16_t allocate(const std::string& session,
+                      const std::string& host,
+                      const std::string& connection,
+                      uint16_t base,
+                      uint16_t preferred = 0) {
+      if (base == 0) {
+        return 0;
+      }
+      std::unique_lock lock(m_mutex);
+      auto& ports = m_sessions[session][host];
+      auto it = ports.assigned.find(connection);
+      if (it != ports.assigned.end()) {
+        return it->second;
+      }
+      uint32_t port = base;
+      auto held = ports.reserved.find(preferred);
+      if (preferred >= base &&
+          (ports.used.count(preferred) == 0 ||
+           (held != ports.reserved.end() && held->second == connection))) {
+        port = preferred;
+        ports.reserved.erase(preferred);
+      }
+      else {
+        while (ports.used.count(port)) {
+          port++;
+        }
+      }
+      if (port > 65535) {
+        throw BadConf(ERS_HERE, "No free port above " + std::to_string(base) +
+                      " on host " + host + " for " + connection);
+      }
+      ports.used.insert(port);
+      ports.assigned[connection] = port;
+      TLOG_DEBUG(11) << "Allocated port " << port << " on " << host << " to " << connection;
+      return port;
+    }
+
+    /// Whether any port of host has been allocated or reserved for session
+    bool has_host(const std::string& session, const std::string& host) {
+      std::unique_lock lock(m_mutex);
+      auto it = m_sessions.find(session);
+      return it != m_sessions.end() && it->second.count(host) != 0;
+    }
+
+    /**
+     * Record that connection already has port on host (e.g. in the
+     * database), so that no other connection is given it, unless the
+     * port is taken already. Returns true if the port was reserved.
+     */
+    bool reserve(const std::string& session,
+                 const std::string& host,
+                 const std::string& connection,
+                 uint16_t port) {
+      std::unique_lock lock(m_mutex);
+      auto& ports = m_sessions[session][host];
+      if (port == 0 || ports.used.count(port)) {
+        return false;
+      }
+      ports.used.insert(port);
+      ports.reserved[port] = connection;
+      return true;
+    }
+
+    /// Forget all the allocations made for session
+    void reset(const std::string& session) {
+      std::unique_lock lock(m_mutex);
+      m_sessions.erase(session);
+    }
+
+  private:
+    PortAllocator() = default;
+
+    struct HostPorts {
+      std::set<uint32_t> used;
+      std::map<std::string, uint16_t> assigned;
+      std::map<uint32_t, std::string> reserved; // by reserve(), not yet allocated
+    };
+
+    std::mutex m_mutex;
+    std::map<std::string, std::map<std::string, HostPorts>> m_sessions;
+  }; // PortAllocator
+
+} // namespace dunedaq::readoutdal
+#endif // PORTALLOCATOR_HPP
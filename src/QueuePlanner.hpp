@@ -0,0 +1,88 @@
+/**
+ * @file QueuePlanner.hpp
+ *
+ * Configuration of generated queues from their QueueDescriptor and
+ * the topology of the modules they connect
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef QUEUEPLANNER_HPP
+#define QUEUEPLANNER_HPP
+
+#include "ConfUtils.hpp"
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include "readoutdal/QueueDescriptor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * The fastest queue type that is safe for the given number of
+   * producers and consumers, unless the descriptor's auto_queue_type
+   * is false in which case its queue_type is used as is.
+   */
+  inline std::string select_queue_type(const QueueDescriptor* desc,
+                                       size_t producers,
+                                       size_t consumers) {
+    if (!desc->get_auto_queue_type()) {
+      return desc->get_queue_type();
+    }
+    if (producers <= 1 && consumers <= 1) {
+      return "kFollySPSCQueue";
+    }
+    return "kFollyMPMCQueue";
+  }
+
+  /**
+   * Capacity of a queue. Without a latency budget this is the
+   * descriptor's capacity. With one it is the number of elements
+   * arriving at rate_hz (the total over all producers) during the
+   * budget, or, if the rate is not known, the descriptor's capacity
+   * for each producer.
+   */
+  inline uint32_t queue_capacity(const QueueDescriptor* desc,
+                                 size_t producers,
+                                 double rate_hz) {
+    auto budget = desc->get_latency_budget_ms();
+    if (budget == 0) {
+      return desc->get_capacity();
+    }
+    if (rate_hz > 0) {
+      auto capacity = std::ceil(rate_hz * budget / 1000.0);
+      return static_cast<uint32_t>(std::clamp(capacity, 1.0, double(UINT32_MAX)));
+    }
+    return desc->get_capacity() * std::max<size_t>(producers, 1);
+  }
+
+  /**
+   * Create (or update) a Queue object configured from desc for the
+   * given number of producers and consumers and the expected total
+   * element rate (0 if unknown).
+   */
+  inline void create_queue(oksdbinterfaces::Configuration* confdb,
+                           const std::string& dbfile,
+                           const std::string& uid,
+                           const QueueDescriptor* desc,
+                           size_t producers,
+                           size_t consumers,
+                           double rate_hz,
+                           oksdbinterfaces::ConfigObject& queueObj) {
+    create_object(confdb, dbfile, "Queue", uid, queueObj);
+    queueObj.set_by_val<std::string>("data_type", desc->get_data_type());
+    queueObj.set_by_val<std::string>("queue_type",
+                                     select_queue_type(desc, producers, consumers));
+    queueObj.set_by_val<uint32_t>("capacity", queue_capacity(desc, producers, rate_hz));
+  }
+
+} // namespace dunedaq::readoutdal
+#endif // QUEUEPLANNER_HPP
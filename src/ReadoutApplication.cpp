@@ -8,27 +8,47 @@
  * received with this code.
  */
 
+#include "ConfUtils.hpp"
+#include "CorePlanner.hpp"
+#include "GenerationPass.hpp"
+#include "MemoryModel.hpp"
 #include "ModuleFactory.hpp"
+#include "QueuePlanner.hpp"
+#include "ReadoutSources.hpp"
+#include "StorageModel.hpp"
+#include "StreamRates.hpp"
 
 #include "oksdbinterfaces/Configuration.hpp"
 #include "oks/kernel.hpp"
 
 #include "coredal/Connection.hpp"
 #include "coredal/NetworkConnection.hpp"
+#include "coredal/NetworkDevice.hpp"
+#include "coredal/ProcessingResource.hpp"
 #include "coredal/ResourceSet.hpp"
 #include "coredal/Session.hpp"
+#include "coredal/StorageDevice.hpp"
 
+#include "readoutdal/DataProcessor.hpp"
 #include "readoutdal/DataReader.hpp"
 #include "readoutdal/DataReaderConf.hpp"
+#include "readoutdal/DataStorageDevice.hpp"
 #include "readoutdal/DLH.hpp"
 #include "readoutdal/DROStreamConf.hpp"
+#include "readoutdal/EthStreamParameters.hpp"
+#include "readoutdal/FlxStreamParameters.hpp"
+#include "readoutdal/LatencyBuffer.hpp"
 #include "readoutdal/LinkHandlerConf.hpp"
+#include "readoutdal/NICReceiverConf.hpp"
 #include "readoutdal/NetworkConnectionRule.hpp"
 #include "readoutdal/NetworkConnectionDescriptor.hpp"
 #include "readoutdal/QueueConnectionRule.hpp"
 #include "readoutdal/QueueDescriptor.hpp"
 #include "readoutdal/ReadoutApplication.hpp"
+#include "readoutdal/RoHwConfig.hpp"
 #include "readoutdal/ReadoutGroup.hpp"
+#include "readoutdal/ReadoutHost.hpp"
+#include "readoutdal/SessionUtils.hpp"
 #include "readoutdal/TPHandler.hpp"
 #include "readoutdal/TPHandlerConf.hpp"
 
@@ -36,6 +56,10 @@
 
 #include "logging/Logging.hpp"
 
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -52,6 +76,223 @@ __reg__("ReadoutApplication", [] (const SmartDaqApplication* smartApp,
     return app->generate_modules(confdb, dbfile, session);
   });
 
+namespace {
+
+  /**
+   * Per-stream changes to the application's LinkHandlerConf. Streams
+   * needing the same changes share one generated copy of the
+   * LinkHandlerConf and its LatencyBuffer.
+   */
+  struct LinkHandlerVariant {
+    int16_t numa_node = -1;
+    uint32_t lb_size = 0;
+    uint32_t alignment_size = 0;
+    uint32_t streaming_buffer_size = 0;
+
+    std::string suffix() const {
+      std::string sfx;
+      if (numa_node >= 0) {
+        sfx += "-numa" + std::to_string(numa_node);
+      }
+      if (lb_size > 0) {
+        sfx += "-lb" + std::to_string(lb_size);
+      }
+      if (alignment_size > 0) {
+        sfx += "-al" + std::to_string(alignment_size);
+      }
+      if (streaming_buffer_size > 0) {
+        sfx += "-sb" + std::to_string(streaming_buffer_size);
+      }
+      return sfx;
+    }
+
+    std::string lb_suffix() const {
+      return LinkHandlerVariant{numa_node, lb_size, alignment_size, 0}.suffix();
+    }
+  };
+
+  /**
+   * NUMA node of the device a stream arrives on: the NIC for Ethernet
+   * streams, the readout card for FELIX streams. -1 if unknown.
+   */
+  int16_t
+  stream_numa_node(const DROStreamConf* stream, const RoHwConfig* hwConf) {
+    if (hwConf == nullptr) {
+      return -1;
+    }
+    auto params = stream->get_stream_params();
+    if (auto flx = params->cast<FlxStreamParameters>()) {
+      auto& nodes = hwConf->get_card_numa_nodes();
+      if (flx->get_card() < nodes.size()) {
+        return nodes[flx->get_card()];
+      }
+      return -1;
+    }
+    if (params->cast<EthStreamParameters>()) {
+      return hwConf->get_io_numa_node();
+    }
+    return -1;
+  }
+
+  /**
+   * Least common multiple of two sizes, ignoring one that is 0
+   */
+  uint32_t
+  common_multiple(uint32_t a, uint32_t b) {
+    if (a == 0 || b == 0) {
+      return std::max(a, b);
+    }
+    return std::lcm(a, b);
+  }
+
+  /**
+   * Raw recording file of the DLH of source id on device: the file
+   * name of the LinkHandlerConf's output_file with the source id
+   * inserted before its extension, in the mount point of the device if
+   * known or else in the directory of output_file.
+   */
+  std::string
+  raw_recording_file(const std::string& output_file,
+                     uint32_t id,
+                     const coredal::StorageDevice* device) {
+    std::filesystem::path path(output_file.empty() ? "output.out" : output_file);
+    auto name = path.stem().string() + "_" + std::to_string(id) + path.extension().string();
+    auto dataDevice = device->cast<DataStorageDevice>();
+    if (dataDevice && !dataDevice->get_mount_point().empty()) {
+      return (std::filesystem::path(dataDevice->get_mount_point()) / name).string();
+    }
+    return (path.parent_path() / name).string();
+  }
+
+  oksdbinterfaces::ConfigObject
+  link_handler_variant(oksdbinterfaces::Configuration* confdb,
+                       const std::string& dbfile,
+                       const LinkHandlerConf* base,
+                       const LinkHandlerVariant& variant) {
+    auto suffix = variant.suffix();
+    if (suffix.empty()) {
+      return base->config_object();
+    }
+    auto lb = base->get_latency_buffer();
+    auto lbObj = lb->config_object();
+    if (!variant.lb_suffix().empty()) {
+      clone_shared_object(confdb, dbfile, lb->config_object(),
+                          lb->UID() + variant.lb_suffix(), lbObj);
+      if (variant.numa_node >= 0) {
+        lbObj.set_by_val<bool>("numa_aware", true);
+        lbObj.set_by_val<int16_t>("numa_node", variant.numa_node);
+      }
+      if (variant.lb_size > 0) {
+        lbObj.set_by_val<uint32_t>("size", variant.lb_size);
+      }
+      if (variant.alignment_size > 0) {
+        lbObj.set_by_val<uint32_t>("alignment_size", variant.alignment_size);
+      }
+    }
+
+    oksdbinterfaces::ConfigObject confObj;
+    clone_shared_object(confdb, dbfile, base->config_object(), base->UID() + suffix, confObj);
+    confObj.set_obj("latency_buffer", &lbObj);
+    if (variant.streaming_buffer_size > 0) {
+      confObj.set_by_val<uint32_t>("streaming_buffer_size", variant.streaming_buffer_size);
+    }
+    TLOG_DEBUG(7) << "Using LinkHandlerConf variant " << confObj.UID();
+    return confObj;
+  }
+
+  /**
+   * Split the streams of a readout group over as few DataReaders as
+   * possible so that none receives more than the reader configuration
+   * allows. Streams arriving on the same Ethernet interface or FELIX
+   * card always go to the same reader. The bandwidth of streams not
+   * read by a NICReceiver is estimated from the element_size of the
+   * latency buffer lb.
+   */
+  std::vector<std::vector<const DROStreamConf*>>
+  split_group(const std::vector<const DROStreamConf*>& streams,
+              const DataReaderConf* rdrConf,
+              const LatencyBuffer* lb) {
+    double capacity = rdrConf->get_max_reader_bandwidth_mbps() * 1e6;
+    if (capacity <= 0) {
+      return {streams};
+    }
+
+    // Bucket the streams by input device, keeping their order
+    std::vector<std::string> keys;
+    std::map<std::string, std::vector<const DROStreamConf*>> buckets;
+    std::map<std::string, double> bandwidth;
+    double total = 0;
+    for (auto stream : streams) {
+      auto params = stream->get_stream_params();
+      std::string key = "stream-" + stream->UID();
+      if (auto eth = params->cast<EthStreamParameters>()) {
+        key = "iface-" + std::to_string(eth->get_rx_iface());
+      }
+      else if (auto flx = params->cast<FlxStreamParameters>()) {
+        key = "card-" + std::to_string(flx->get_card());
+      }
+      if (buckets.count(key) == 0) {
+        keys.push_back(key);
+      }
+      buckets[key].push_back(stream);
+      auto rate = stream_bandwidth(stream, rdrConf, lb);
+      bandwidth[key] += rate;
+      total += rate;
+    }
+    if (total == 0 && !streams.empty()) {
+      ers::warning(BadConf(ERS_HERE, "Bandwidth of the streams of " + rdrConf->UID() +
+                           " unknown (give rate_hz and a NICStatsConf or LatencyBuffer"
+                           " element_size), not splitting"));
+    }
+    if (total <= capacity) {
+      return {streams};
+    }
+
+    // First fit decreasing
+    std::stable_sort(keys.begin(), keys.end(), [&bandwidth](auto& a, auto& b) {
+      return bandwidth[a] > bandwidth[b];
+    });
+    std::vector<std::vector<const DROStreamConf*>> readers;
+    std::vector<double> load;
+    for (auto& key : keys) {
+      if (bandwidth[key] > capacity) {
+        ers::warning(ResourceShortage(ERS_HERE, key,
+                                      "streams on one input exceed max_reader_bandwidth_mbps of " +
+                                      rdrConf->UID()));
+      }
+      size_t reader = 0;
+      while (reader < readers.size() && load[reader] + bandwidth[key] > capacity) {
+        reader++;
+      }
+      if (reader == readers.size()) {
+        readers.emplace_back();
+        load.push_back(0);
+      }
+      readers[reader].insert(readers[reader].end(), buckets[key].begin(), buckets[key].end());
+      load[reader] += bandwidth[key];
+    }
+    TLOG_DEBUG(7) << "Split " << streams.size() << " streams over " << readers.size() << " readers";
+    return readers;
+  }
+
+  /**
+   * The source IDs the streams and TPHandlers of app use, each with
+   * the UID of its user
+   */
+  std::map<uint32_t, std::string>
+  source_ids(const ReadoutApplication* app, const coredal::Session* session) {
+    std::map<uint32_t, std::string> ids;
+    for (auto stream : enabled_streams(app, session)) {
+      ids.emplace(stream->get_src_id(), stream->UID());
+    }
+    for (auto id : tp_handler_ids(app, session)) {
+      ids.emplace(id, "tphandler-" + std::to_string(id));
+    }
+    return ids;
+  }
+
+} // namespace
+
 std::vector<const coredal::DaqModule*> 
 ReadoutApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
                                      const std::string& dbfile,
@@ -60,8 +301,38 @@ ReadoutApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
 
   std::vector<const coredal::DaqModule*> modules;
 
+  auto host = application_host(this);
+
+  // Bind our request/response connections to the data network
+  // interface of the host, falling back to the front-end input device
+  auto dataIp = application_data_ip(this);
+  if (dataIp.empty() && get_uses() && get_uses()->get_io_device()) {
+    for (auto& ip : get_uses()->get_io_device()->get_ip_address()) {
+      if (!ip.empty()) {
+        dataIp = ip;
+        break;
+      }
+    }
+  }
   auto dlhConf = get_link_handler();
   auto dlhClass = dlhConf->get_template_for();
+  auto dlhLatencyBuffer = dlhConf->get_latency_buffer();
+
+  // Cores for the data readers come from the receiver processor, the
+  // link and TP handlers (which do the hit finding) get the rest of
+  // the hit finding processor
+  std::vector<uint16_t> recvCoreList;
+  std::vector<uint16_t> hitCoreList;
+  if (auto hwConf = get_uses()) {
+    if (hwConf->get_recv_processor()) {
+      recvCoreList = hwConf->get_recv_processor()->get_cpu_cores();
+    }
+    if (hwConf->get_hitFindingProc()) {
+      hitCoreList = hwConf->get_hitFindingProc()->get_cpu_cores();
+    }
+  }
+  CorePlanner recvCores("recv_processor of " + UID(), session->UID(), host, recvCoreList);
+  CorePlanner hitCores("hitFindingProc of " + UID(), session->UID(), host, hitCoreList, recvCoreList);
 
   // Process the queue rules looking for inputs to our DL/TP handler modules
   const QueueDescriptor* dlhInputQDesc = nullptr;
@@ -89,57 +360,15 @@ ReadoutApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
     }
   }
 
-  // Now create the TP Handler and its associated queue and network
-  // connections if we have a TP handler config
-  oksdbinterfaces::ConfigObject tpQueueObj;
-  oksdbinterfaces::ConfigObject tpNetObj;
-  auto tpHandlerConf = get_tp_handler();
-  if (tpHandlerConf) {
-    if (tpNetDesc == nullptr) {
-      throw (BadConf(ERS_HERE, "No tpHandler network descriptor given"));
-    }
-    if (tpInputQDesc == nullptr) {
-      throw (BadConf(ERS_HERE, "No tpHandler input queue descriptor given"));
-    }
-    auto tpsrc = get_tp_src_id();
-    if (tpsrc == 0) {
-      throw (BadConf(ERS_HERE, "No TPHandler src_id given"));
-    }
-    std::string tpQueueUid("inputToTPH-"+std::to_string(tpsrc));
-    confdb->create(dbfile, "Queue", tpQueueUid, tpQueueObj);
-    tpQueueObj.set_by_val<std::string>("data_type", tpInputQDesc->get_data_type());
-    tpQueueObj.set_by_val<std::string>("queue_type", tpInputQDesc->get_queue_type());
-    tpQueueObj.set_by_val<uint32_t>("capacity", tpInputQDesc->get_capacity());
-
-    std::string tpNetUid("ReqToTPH-"+std::to_string(tpsrc));
-    confdb->create(dbfile, "NetworkConnection", tpNetUid, tpNetObj);
-    tpNetObj.set_by_val<std::string>("data_type", tpNetDesc->get_data_type());
-    tpNetObj.set_by_val<std::string>("connection_type", tpNetDesc->get_connection_type());
-    tpNetObj.set_by_val<std::string>("uri", tpNetDesc->get_uri());
-    tpNetObj.set_by_val<uint16_t>("port", tpNetDesc->get_port());
-    
-    auto tphConfObj = tpHandlerConf->config_object();
-    oksdbinterfaces::ConfigObject tpObj;
-    std::string tpUid("tphandler-"+std::to_string(tpsrc));
-    confdb->create(dbfile, "TPHandler", tpUid, tpObj);
-    tpObj.set_by_val<uint32_t>("source_id", tpsrc);
-    tpObj.set_obj("handler_configuration", &tphConfObj);
-    tpObj.set_objs("inputs", {&tpQueueObj, &tpNetObj});
-
-    // Add to our list of modules to return
-    modules.push_back(confdb->get<TPHandler>(tpUid));
-  }
-
-  // Now create the DataReader objects, one per group of data streams
   auto rdrConf = get_data_reader();
   if (rdrConf == 0) {
     throw (BadConf(ERS_HERE, "No DataReader configuration given"));
   }
 
-  int rnum = 0;
-  int port_offset = 0;
-  // Create a DataReader for each (non-disabled) group and a Data Link
-  // Handler for each stream of this DataReader
+  // Collect the enabled streams of each enabled readout group, split
+  // into the sets handled by one DataReader each
+  std::vector<std::vector<const DROStreamConf*>> readoutGroups;
+  size_t nStreams = 0;
   //for (auto roGroup : get_readout_groups()) {
   for (auto roGroup : get_contains()) {
     if (roGroup->disabled(*session)) {
@@ -150,7 +379,7 @@ ReadoutApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
     if (rset == nullptr) {
         throw (BadConf(ERS_HERE, "ReadoutApplication contains something other than ReadoutGroup"));
     }
-    std::vector<const coredal::Connection*> outputQueues;
+    std::vector<const DROStreamConf*> streams;
     for (auto res : rset->get_contains()) {
       auto stream = res->cast<DROStreamConf>();
       if (stream == nullptr) {
@@ -160,37 +389,189 @@ ReadoutApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
         TLOG_DEBUG(7) << "Ignoring disabled DROStreamConf " << stream->UID();
         continue;
       }
+      streams.push_back(stream);
+    }
+    nStreams += streams.size();
+    for (auto& readerStreams : split_group(streams, rdrConf, dlhLatencyBuffer)) {
+      readoutGroups.push_back(readerStreams);
+    }
+  }
+
+  // Now create the TP Handlers and their associated queue and network
+  // connections if we have a TP handler config. Handler n has source
+  // ID tp_src_id+n and takes the TPs of every nTPHandlers'th stream.
+  std::vector<oksdbinterfaces::ConfigObject> tpQueueObjs;
+  auto tpHandlerConf = get_tp_handler();
+  if (tpHandlerConf) {
+    if (tpNetDesc == nullptr) {
+      throw (BadConf(ERS_HERE, "No tpHandler network descriptor given"));
+    }
+    if (tpInputQDesc == nullptr) {
+      throw (BadConf(ERS_HERE, "No tpHandler input queue descriptor given"));
+    }
+    auto tpsrc = get_tp_src_id();
+    if (tpsrc == 0) {
+      throw (BadConf(ERS_HERE, "No TPHandler src_id given"));
+    }
+    uint32_t nTPHandlers = tp_handler_count(this, nStreams);
+    for (auto& streams : readoutGroups) {
+      for (auto stream : streams) {
+        auto id = stream->get_src_id();
+        if (id >= tpsrc && id < tpsrc + nTPHandlers) {
+          throw (BadConf(ERS_HERE, "TPHandler source ID " + std::to_string(id) +
+                         " is also used by stream " + stream->UID()));
+        }
+      }
+    }
+    // The whole range must also be free in the other readout
+    // applications of the session
+    for (auto app : get_smart_applications(session)) {
+      auto roApp = app->cast<ReadoutApplication>();
+      if (roApp == nullptr || roApp->UID() == UID()) {
+        continue;
+      }
+      auto ids = source_ids(roApp, session);
+      auto it = ids.lower_bound(tpsrc);
+      if (it != ids.end() && it->first < tpsrc + nTPHandlers) {
+        throw (BadConf(ERS_HERE, "TPHandler source ID " + std::to_string(it->first) +
+                       " of " + UID() + " is also used by " + it->second +
+                       " of " + roApp->UID()));
+      }
+    }
+
+    auto tphConfObj = tpHandlerConf->config_object();
+    for (uint32_t shard = 0; shard < nTPHandlers; shard++) {
+      auto srcId = tpsrc + shard;
+      // Each TP handler is fed by the DLHs of its share of the streams.
+      // The TP rate is not known in advance.
+      size_t producers = nStreams / nTPHandlers + (shard < nStreams % nTPHandlers ? 1 : 0);
+      std::string tpQueueUid("inputToTPH-"+std::to_string(srcId));
+      tpQueueObjs.emplace_back();
+      auto& tpQueueObj = tpQueueObjs.back();
+      create_queue(confdb, dbfile, tpQueueUid, tpInputQDesc, producers, 1, 0, tpQueueObj);
+
+      std::string tpNetUid("ReqToTPH-"+std::to_string(srcId));
+      oksdbinterfaces::ConfigObject tpNetObj;
+      create_network_connection(confdb, GenerationPass::instance().shared_file(dbfile),
+                                tpNetUid, tpNetDesc, session, host, dataIp, tpNetObj);
+
+      oksdbinterfaces::ConfigObject tpObj;
+      std::string tpUid("tphandler-"+std::to_string(srcId));
+      create_object(confdb, dbfile, "TPHandler", tpUid, tpObj);
+      tpObj.set_by_val<uint32_t>("source_id", srcId);
+      if (hitCores.enabled()) {
+        tpObj.set_by_val<std::vector<uint16_t>>(
+          "cpu_affinity", hitCores.allocate(tpHandlerConf->get_handler_threads(), tpUid));
+      }
+      tpObj.set_obj("handler_configuration", &tphConfObj);
+      tpObj.set_objs("inputs", {&tpQueueObj, &tpNetObj});
+
+      // Add to our list of modules to return
+      modules.push_back(confdb->get<TPHandler>(tpUid));
+    }
+  }
+
+  // Buffers are aligned to the pages of the host
+  auto readoutHost = get_runs_on() ? get_runs_on()->cast<ReadoutHost>() : nullptr;
+
+  std::vector<const coredal::StorageDevice*> snbDevices;
+  if (get_uses()) {
+    snbDevices = get_uses()->get_snb_storage();
+  }
+
+  int rnum = 0;
+  uint32_t streamIndex = 0;
+  // Create a DataReader for each set of streams and a Data Link
+  // Handler for each stream of this DataReader
+  for (auto& streams : readoutGroups) {
+    std::vector<const coredal::Connection*> outputQueues;
+    for (auto stream : streams) {
       auto id = stream->get_src_id();
       std::string uid("DLH-"+std::to_string(id));
       oksdbinterfaces::ConfigObject dlhObj;
       TLOG_DEBUG(7) <<  "creating OKS configuration object for Data Link Handler class " << dlhClass;
-      confdb->create(dbfile, dlhClass, uid, dlhObj);
+      create_object(confdb, dbfile, dlhClass, uid, dlhObj);
       dlhObj.set_by_val<uint32_t>("source_id", id);
-      dlhObj.set_obj("handler_configuration", &dlhConf->config_object());
-      if (tpHandlerConf) {
-        dlhObj.set_objs("outputs", {&tpQueueObj});
+      if (hitCores.enabled()) {
+        // Plus one core for the TPG thread, as validate_cpu() counts it
+        auto dlhThreads = dlhConf->get_handlier_threads();
+        if (dlhConf->get_data_processor() && dlhConf->get_data_processor()->get_tpg_enabled()) {
+          dlhThreads++;
+        }
+        dlhObj.set_by_val<std::vector<uint16_t>>(
+          "cpu_affinity", hitCores.allocate(dlhThreads, uid));
+      }
+
+      // Place the latency buffer on the NUMA node of the stream's
+      // input device
+      LinkHandlerVariant variant;
+      if (dlhLatencyBuffer->get_numa_aware()) {
+        auto node = stream_numa_node(stream, get_uses());
+        if (node >= 0 && node != dlhLatencyBuffer->get_numa_node()) {
+          variant.numa_node = node;
+        }
+      }
+      // Size it to cover the request timeout at the stream's rate
+      uint32_t slots = dlhLatencyBuffer->get_size();
+      if (dlhLatencyBuffer->get_auto_size()) {
+        slots = latency_buffer_slots(dlhLatencyBuffer, stream_packet_rate(stream, rdrConf),
+                                     dlhConf->get_request_timeout());
+        if (slots != dlhLatencyBuffer->get_size()) {
+          variant.lb_size = slots;
+        }
       }
+      // Stripe the raw recording files over the SNB storage devices
+      // by source ID, so that applications sharing the devices spread
+      // over them too, with streaming buffers aligned to the device
+      // (and with auto_streaming_buffer_size to the host's pages) for
+      // O_DIRECT
+      uint32_t directBlock = 0;
+      if (dlhConf->get_enable_raw_recording() && !snbDevices.empty()) {
+        auto device = snbDevices[id % snbDevices.size()];
+        dlhObj.set_by_val<std::string>("output_file",
+                                       raw_recording_file(dlhConf->get_output_file(), id, device));
+        if (dlhConf->get_use_o_direct()) {
+          directBlock = device_block_size(device);
+        }
+        uint32_t unit = directBlock;
+        if (dlhConf->get_auto_streaming_buffer_size()) {
+          unit = common_multiple(unit, host_page_size(readoutHost, false));
+        }
+        if (unit > 0 && dlhConf->get_streaming_buffer_size() % unit != 0) {
+          variant.streaming_buffer_size = round_up(dlhConf->get_streaming_buffer_size(), unit);
+        }
+      }
+      // Align the latency buffer to the pages it is allocated in and
+      // to the recording device
+      if (dlhLatencyBuffer->get_auto_alignment()) {
+        auto alignment = common_multiple(
+          host_page_size(readoutHost, dlhLatencyBuffer->get_intrinsic_allocator()), directBlock);
+        if (alignment != dlhLatencyBuffer->get_alignment_size()) {
+          variant.alignment_size = alignment;
+        }
+      }
+      auto dlhConfObj = link_handler_variant(confdb, dbfile, dlhConf, variant);
+      dlhObj.set_obj("handler_configuration", &dlhConfObj);
+      if (!tpQueueObjs.empty()) {
+        dlhObj.set_objs("outputs", {&tpQueueObjs[streamIndex % tpQueueObjs.size()]});
+      }
+      streamIndex++;
       std::string queueUid("inputToDLH-"+std::to_string(id));
       oksdbinterfaces::ConfigObject queueObj;
-      confdb->create(dbfile, "Queue", queueUid, queueObj);
-      queueObj.set_by_val<std::string>("data_type", dlhInputQDesc->get_data_type());
-      queueObj.set_by_val<std::string>("queue_type", dlhInputQDesc->get_queue_type());
-      queueObj.set_by_val<uint32_t>("capacity", dlhInputQDesc->get_capacity());
+      // One reader feeds each DLH
+      create_queue(confdb, dbfile, queueUid, dlhInputQDesc, 1, 1,
+                   stream_packet_rate(stream, rdrConf), queueObj);
 
       std::ostringstream uidStream;
       uidStream.fill('0');
       uidStream << dlhNetDesc->get_uid_base() << std::hex << std::setw(8) << id;
       std::string netUid=uidStream.str();
       oksdbinterfaces::ConfigObject netObj;
-      confdb->create(dbfile, "NetworkConnection", netUid, netObj);
-      netObj.set_by_val<std::string>("data_type", dlhNetDesc->get_data_type());
-      netObj.set_by_val<std::string>("connection_type", dlhNetDesc->get_connection_type());
-      netObj.set_by_val<std::string>("uri", dlhNetDesc->get_uri());
-      uint16_t port = dlhNetDesc->get_port();
-      port = port ? port+port_offset : port;
-      netObj.set_by_val<uint16_t>("port", port);
-
-      port_offset++;
+      // The TRBuilders send their data requests here, so it goes in
+      // the shared file
+      create_network_connection(confdb, GenerationPass::instance().shared_file(dbfile),
+                                netUid, dlhNetDesc, session, host, dataIp, netObj);
+
       std::vector<const oksdbinterfaces::ConfigObject*> inputObjs{
         &(confdb->get<coredal::Connection>(queueUid)->config_object()),
         &(confdb->get<coredal::Connection>(netUid)->config_object())
@@ -207,17 +588,65 @@ ReadoutApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
     std::string readerClass = rdrConf->get_template_for();
     oksdbinterfaces::ConfigObject readerObj;
     TLOG_DEBUG(7) <<  "creating OKS configuration object for Data reader class " << readerClass;
-    confdb->create(dbfile, readerClass, readerUid, readerObj);
+    create_object(confdb, dbfile, readerClass, readerUid, readerObj);
 
     std::vector<const oksdbinterfaces::ConfigObject*> qObjs;
     for (auto q : outputQueues) {
       qObjs.push_back(&q->config_object());
     }
     readerObj.set_objs("outputs", qObjs);
-    readerObj.set_obj("configuration", &rdrConf->config_object());
+
+    // NICReceivers need to know the streams they receive. The
+    // relationship is exclusive, so first take each stream away from
+    // any other reader (e.g. a stale one from an earlier split) that
+    // still holds it. Reused readers had their streams cleared by
+    // create_object().
+    if (rdrConf->cast<NICReceiverConf>()) {
+      std::vector<const oksdbinterfaces::ConfigObject*> streamObjs;
+      for (auto stream : streams) {
+        auto streamObj = stream->config_object();
+        std::vector<oksdbinterfaces::ConfigObject> holders;
+        streamObj.referenced_by(holders, "streams", false);
+        for (auto& holder : holders) {
+          if (holder.UID() == readerUid) {
+            continue;
+          }
+          std::vector<oksdbinterfaces::ConfigObject> held;
+          holder.get("streams", held);
+          std::vector<const oksdbinterfaces::ConfigObject*> keep;
+          for (auto& other : held) {
+            if (other.UID() != stream->UID()) {
+              keep.push_back(&other);
+            }
+          }
+          holder.set_objs("streams", keep);
+        }
+        streamObjs.push_back(&stream->config_object());
+      }
+      readerObj.set_objs("streams", streamObjs);
+    }
+
+    // Give each reader its own lcores. NICReceivers need their own copy
+    // of the NICReceiverConf with the EAL arguments set accordingly.
+    auto rdrConfObj = rdrConf->config_object();
+    if (recvCores.enabled()) {
+      auto nicConf = rdrConf->cast<NICReceiverConf>();
+      size_t nCores = 1;
+      if (nicConf) {
+        nCores = std::max<size_t>(parse_core_list(get_option(nicConf->get_eal_args(), "-l")).size(), 1);
+      }
+      auto cores = recvCores.allocate(nCores, readerUid);
+      readerObj.set_by_val<std::vector<uint16_t>>("cpu_affinity", cores);
+      if (nicConf && !cores.empty()) {
+        clone_object(confdb, dbfile, rdrConf->config_object(), readerUid + "-conf", rdrConfObj);
+        rdrConfObj.set_by_val<std::string>("eal_args", set_eal_lcores(nicConf->get_eal_args(), cores));
+      }
+    }
+    readerObj.set_obj("configuration", &rdrConfObj);
 
     modules.push_back(confdb->get<DataReader>(readerUid));
   }
+
   //oks::OksFile::set_nolock_mode(false);
   return modules;
 }
@@ -0,0 +1,81 @@
+/**
+ * @file ReadoutSources.hpp
+ *
+ * The streams and TPHandlers a ReadoutApplication generates modules
+ * for, as seen from the other applications of the session
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef READOUTSOURCES_HPP
+#define READOUTSOURCES_HPP
+
+#include "coredal/Session.hpp"
+
+#include "readoutdal/DROStreamConf.hpp"
+#include "readoutdal/ReadoutApplication.hpp"
+#include "readoutdal/ReadoutGroup.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * The enabled streams of the enabled ReadoutGroups of app. Anything
+   * else app contains is skipped: ReadoutApplication::generate_modules()
+   * rejects it.
+   */
+  inline std::vector<const DROStreamConf*>
+  enabled_streams(const ReadoutApplication* app, const coredal::Session* session) {
+    std::vector<const DROStreamConf*> streams;
+    for (auto roGroup : app->get_contains()) {
+      auto rset = roGroup->cast<ReadoutGroup>();
+      if (rset == nullptr || roGroup->disabled(*session)) {
+        continue;
+      }
+      for (auto res : rset->get_contains()) {
+        auto stream = res->cast<DROStreamConf>();
+        if (stream != nullptr && !stream->disabled(*session)) {
+          streams.push_back(stream);
+        }
+      }
+    }
+    return streams;
+  }
+
+  /**
+   * Number of TPHandlers app generates for nStreams enabled streams:
+   * tp_handlers, at least one and no more than there are streams
+   */
+  inline uint32_t tp_handler_count(const ReadoutApplication* app, size_t nStreams) {
+    uint32_t nTPHandlers = std::max<uint32_t>(1, app->get_tp_handlers());
+    if (nStreams > 0 && nTPHandlers > nStreams) {
+      nTPHandlers = nStreams;
+    }
+    return nTPHandlers;
+  }
+
+  /**
+   * The source IDs of the TPHandlers app generates, empty if it has
+   * none
+   */
+  inline std::vector<uint32_t>
+  tp_handler_ids(const ReadoutApplication* app, const coredal::Session* session) {
+    std::vector<uint32_t> ids;
+    auto tpsrc = app->get_tp_src_id();
+    if (app->get_tp_handler() == nullptr || tpsrc == 0) {
+      return ids;
+    }
+    auto nTPHandlers = tp_handler_count(app, enabled_streams(app, session).size());
+    for (uint32_t shard = 0; shard < nTPHandlers; shard++) {
+      ids.push_back(tpsrc + shard);
+    }
+    return ids;
+  }
+
+} // namespace dunedaq::readoutdal
+#endif // READOUTSOURCES_HPP
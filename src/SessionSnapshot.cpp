@@ -0,0 +1,477 @@
+/**
+ * @file SessionSnapshot.cpp
+ *
+ * Writer and memory mapped reader of session snapshot files
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "readoutdal/SessionSnapshot.hpp"
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+#include "oksdbinterfaces/Schema.hpp"
+
+#include "coredal/DaqModule.hpp"
+
+#include "readoutdal/SmartDaqApplication.hpp"
+
+#include "readoutdalIssues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace dunedaq;
+using namespace dunedaq::readoutdal;
+using namespace dunedaq::readoutdal::snapshot;
+
+namespace {
+
+  struct PendingValue {
+    uint32_t name;
+    uint8_t type;
+    uint64_t data;
+  };
+
+  struct PendingObject {
+    oksdbinterfaces::ConfigObject obj;
+    std::vector<PendingValue> values;
+    std::vector<std::pair<uint32_t, size_t>> refs; // name, pending index
+  };
+
+  class SnapshotWriter {
+  public:
+    explicit SnapshotWriter(oksdbinterfaces::Configuration* confdb) : m_confdb(confdb) {
+      m_strings.push_back('\0');
+    }
+
+    uint32_t add_string(const std::string& str) {
+      auto it = m_string_offsets.find(str);
+      if (it != m_string_offsets.end()) {
+        return it->second;
+      }
+      uint32_t offset = m_strings.size();
+      m_strings.insert(m_strings.end(), str.begin(), str.end());
+      m_strings.push_back('\0');
+      m_string_offsets[str] = offset;
+      return offset;
+    }
+
+    /// Add obj and everything reachable from it, returning its pending index
+    size_t add_object(const oksdbinterfaces::ConfigObject& obj) {
+      auto key = obj.UID() + "@" + obj.class_name();
+      auto it = m_indices.find(key);
+      if (it != m_indices.end()) {
+        return it->second;
+      }
+      size_t first = m_objects.size();
+      m_indices[key] = first;
+      m_objects.push_back({obj, {}, {}});
+      std::deque<size_t> todo{first};
+      while (!todo.empty()) {
+        auto index = todo.front();
+        todo.pop_front();
+        visit(index, todo);
+      }
+      return first;
+    }
+
+    void write(const std::vector<std::pair<std::string, std::vector<size_t>>>& apps,
+               const std::string& filename);
+
+  private:
+    template <typename T>
+    void add_values(oksdbinterfaces::ConfigObject& obj,
+                    const oksdbinterfaces::attribute_t& attr,
+                    std::vector<PendingValue>& values) {
+      std::vector<T> vals;
+      if (attr.p_is_multi_value) {
+        obj.get(attr.p_name, vals);
+      }
+      else {
+        T val;
+        obj.get(attr.p_name, val);
+        vals.push_back(val);
+      }
+      auto name = add_string(attr.p_name);
+      for (const auto& val : vals) {
+        if constexpr (std::is_same_v<T, std::string>) {
+          values.push_back({name, kString, add_string(val)});
+        }
+        else if constexpr (std::is_same_v<T, bool>) {
+          values.push_back({name, kBool, val ? 1u : 0u});
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+          double dval = val;
+          uint64_t data;
+          std::memcpy(&data, &dval, sizeof(data));
+          values.push_back({name, kFloat, data});
+        }
+        else if constexpr (std::is_signed_v<T>) {
+          values.push_back({name, kSigned, static_cast<uint64_t>(static_cast<int64_t>(val))});
+        }
+        else {
+          values.push_back({name, kUnsigned, static_cast<uint64_t>(val)});
+        }
+      }
+    }
+
+    void visit(size_t index, std::deque<size_t>& todo) {
+      auto obj = m_objects[index].obj;
+      const auto& cinfo = m_confdb->get_class_info(obj.class_name());
+      std::vector<PendingValue> values;
+      for (const auto& attr : cinfo.p_attributes) {
+        switch (attr.p_type) {
+        case oksdbinterfaces::bool_type: add_values<bool>(obj, attr, values); break;
+        case oksdbinterfaces::s8_type: add_values<int8_t>(obj, attr, values); break;
+        case oksdbinterfaces::u8_type: add_values<uint8_t>(obj, attr, values); break;
+        case oksdbinterfaces::s16_type: add_values<int16_t>(obj, attr, values); break;
+        case oksdbinterfaces::u16_type: add_values<uint16_t>(obj, attr, values); break;
+        case oksdbinterfaces::s32_type: add_values<int32_t>(obj, attr, values); break;
+        case oksdbinterfaces::u32_type: add_values<uint32_t>(obj, attr, values); break;
+        case oksdbinterfaces::s64_type: add_values<int64_t>(obj, attr, values); break;
+        case oksdbinterfaces::u64_type: add_values<uint64_t>(obj, attr, values); break;
+        case oksdbinterfaces::float_type: add_values<float>(obj, attr, values); break;
+        case oksdbinterfaces::double_type: add_values<double>(obj, attr, values); break;
+        default: add_values<std::string>(obj, attr, values); break;
+        }
+      }
+
+      std::vector<std::pair<uint32_t, size_t>> refs;
+      for (const auto& rel : cinfo.p_relationships) {
+        std::vector<oksdbinterfaces::ConfigObject> targets;
+        if (rel.p_cardinality == oksdbinterfaces::zero_or_many ||
+            rel.p_cardinality == oksdbinterfaces::one_or_many) {
+          obj.get(rel.p_name, targets);
+        }
+        else {
+          oksdbinterfaces::ConfigObject target;
+          obj.get(rel.p_name, target);
+          if (!target.is_null()) {
+            targets.push_back(target);
+          }
+        }
+        auto name = add_string(rel.p_name);
+        for (auto& target : targets) {
+          auto key = target.UID() + "@" + target.class_name();
+          auto it = m_indices.find(key);
+          size_t tindex;
+          if (it == m_indices.end()) {
+            tindex = m_objects.size();
+            m_indices[key] = tindex;
+            m_objects.push_back({target, {}, {}});
+            todo.push_back(tindex);
+          }
+          else {
+            tindex = it->second;
+          }
+          refs.emplace_back(name, tindex);
+        }
+      }
+      m_objects[index].values = std::move(values);
+      m_objects[index].refs = std::move(refs);
+    }
+
+    oksdbinterfaces::Configuration* m_confdb;
+    std::vector<char> m_strings;
+    std::map<std::string, uint32_t> m_string_offsets;
+    std::map<std::string, size_t> m_indices;
+    std::deque<PendingObject> m_objects;
+  };
+
+  uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+  }
+
+  template <typename T>
+  void write_section(std::ofstream& out, const std::vector<T>& data, uint64_t offset) {
+    out.seekp(offset);
+    out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+  }
+
+  void SnapshotWriter::write(const std::vector<std::pair<std::string, std::vector<size_t>>>& apps,
+                             const std::string& filename) {
+    // Sort the objects by UID and class so that the reader can bisect
+    std::vector<size_t> order(m_objects.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      auto& oa = m_objects[a].obj;
+      auto& ob = m_objects[b].obj;
+      return std::make_pair(oa.UID(), oa.class_name()) < std::make_pair(ob.UID(), ob.class_name());
+    });
+    std::vector<uint32_t> final_index(m_objects.size());
+    for (size_t pos = 0; pos < order.size(); pos++) {
+      final_index[order[pos]] = pos;
+    }
+
+    std::vector<ObjectRecord> objects;
+    std::vector<ValueRecord> values;
+    std::vector<RefRecord> refs;
+    for (auto index : order) {
+      auto& pending = m_objects[index];
+      ObjectRecord rec{add_string(pending.obj.UID()), add_string(pending.obj.class_name()),
+                       static_cast<uint32_t>(values.size()),
+                       static_cast<uint32_t>(pending.values.size()),
+                       static_cast<uint32_t>(refs.size()),
+                       static_cast<uint32_t>(pending.refs.size())};
+      objects.push_back(rec);
+      for (auto& val : pending.values) {
+        values.push_back({val.name, val.type, {0, 0, 0}, val.data});
+      }
+      for (auto& ref : pending.refs) {
+        refs.push_back({ref.first, final_index[ref.second]});
+      }
+    }
+
+    auto sorted_apps = apps;
+    std::sort(sorted_apps.begin(), sorted_apps.end());
+    std::vector<ApplicationRecord> app_records;
+    std::vector<uint32_t> modules;
+    for (auto& [uid, indices] : sorted_apps) {
+      app_records.push_back({add_string(uid), static_cast<uint32_t>(modules.size()),
+                             static_cast<uint32_t>(indices.size()), 0});
+      for (auto index : indices) {
+        modules.push_back(final_index[index]);
+      }
+    }
+
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = format_version;
+    header.byte_order = byte_order_mark;
+    header.n_applications = app_records.size();
+    header.n_modules = modules.size();
+    header.n_objects = objects.size();
+    header.n_values = values.size();
+    header.n_refs = refs.size();
+    header.applications_offset = align8(sizeof(Header));
+    header.modules_offset =
+      align8(header.applications_offset + app_records.size() * sizeof(ApplicationRecord));
+    header.objects_offset = align8(header.modules_offset + modules.size() * sizeof(uint32_t));
+    header.values_offset = align8(header.objects_offset + objects.size() * sizeof(ObjectRecord));
+    header.refs_offset = align8(header.values_offset + values.size() * sizeof(ValueRecord));
+    header.strings_offset = align8(header.refs_offset + refs.size() * sizeof(RefRecord));
+    header.strings_size = m_strings.size();
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw BadSnapshot(ERS_HERE, filename, "cannot open for writing");
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_section(out, app_records, header.applications_offset);
+    write_section(out, modules, header.modules_offset);
+    write_section(out, objects, header.objects_offset);
+    write_section(out, values, header.values_offset);
+    write_section(out, refs, header.refs_offset);
+    write_section(out, m_strings, header.strings_offset);
+    if (!out) {
+      throw BadSnapshot(ERS_HERE, filename, "write failed");
+    }
+    TLOG_DEBUG(7) << "Wrote " << objects.size() << " objects of " << app_records.size()
+                  << " applications to " << filename;
+  }
+
+} // namespace
+
+void
+dunedaq::readoutdal::write_session_snapshot(oksdbinterfaces::Configuration* confdb,
+                                            const std::vector<GeneratedApplication>& generated,
+                                            const std::string& filename) {
+  SnapshotWriter writer(confdb);
+  std::vector<std::pair<std::string, std::vector<size_t>>> apps;
+  for (auto& gen : generated) {
+    std::vector<size_t> indices;
+    for (auto module : gen.modules) {
+      indices.push_back(writer.add_object(module->config_object()));
+    }
+    apps.emplace_back(gen.application->UID(), indices);
+  }
+  writer.write(apps, filename);
+}
+
+SessionSnapshot::SessionSnapshot(const std::string& filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw BadSnapshot(ERS_HERE, filename, "cannot open");
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    ::close(fd);
+    throw BadSnapshot(ERS_HERE, filename, "file too short");
+  }
+  m_size = st.st_size;
+  m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (m_data == MAP_FAILED) {
+    m_data = nullptr;
+    throw BadSnapshot(ERS_HERE, filename, "mmap failed");
+  }
+
+  auto base = static_cast<const char*>(m_data);
+  m_header = reinterpret_cast<const Header*>(base);
+  std::string error;
+  auto fits = [this](uint64_t offset, uint64_t count, size_t size) {
+    return offset % 8 == 0 && offset <= m_size && count * size <= m_size - offset;
+  };
+  if (std::memcmp(m_header->magic, magic, sizeof(magic)) != 0) {
+    error = "not a session snapshot";
+  }
+  else if (m_header->byte_order != byte_order_mark) {
+    error = "written with a different byte order";
+  }
+  else if (m_header->version != format_version) {
+    error = "unsupported format version " + std::to_string(m_header->version);
+  }
+  else if (!fits(m_header->applications_offset, m_header->n_applications, sizeof(ApplicationRecord)) ||
+           !fits(m_header->modules_offset, m_header->n_modules, sizeof(uint32_t)) ||
+           !fits(m_header->objects_offset, m_header->n_objects, sizeof(ObjectRecord)) ||
+           !fits(m_header->values_offset, m_header->n_values, sizeof(ValueRecord)) ||
+           !fits(m_header->refs_offset, m_header->n_refs, sizeof(RefRecord)) ||
+           !fits(m_header->strings_offset, m_header->strings_size, 1) ||
+           m_header->strings_size == 0 ||
+           base[m_header->strings_offset + m_header->strings_size - 1] != '\0') {
+    error = "truncated or corrupt";
+  }
+  if (!error.empty()) {
+    ::munmap(m_data, m_size);
+    m_data = nullptr;
+    throw BadSnapshot(ERS_HERE, filename, error);
+  }
+
+  m_applications = reinterpret_cast<const ApplicationRecord*>(base + m_header->applications_offset);
+  m_modules = reinterpret_cast<const uint32_t*>(base + m_header->modules_offset);
+  m_objects = reinterpret_cast<const ObjectRecord*>(base + m_header->objects_offset);
+  m_values = reinterpret_cast<const ValueRecord*>(base + m_header->values_offset);
+  m_refs = reinterpret_cast<const RefRecord*>(base + m_header->refs_offset);
+  m_strings = base + m_header->strings_offset;
+}
+
+SessionSnapshot::~SessionSnapshot() {
+  if (m_data) {
+    ::munmap(m_data, m_size);
+  }
+}
+
+std::string_view
+SessionSnapshot::string_at(uint32_t offset) const {
+  if (offset >= m_header->strings_size) {
+    return {};
+  }
+  return std::string_view(m_strings + offset);
+}
+
+std::vector<std::string_view>
+SessionSnapshot::applications() const {
+  std::vector<std::string_view> apps;
+  for (uint32_t index = 0; index < m_header->n_applications; index++) {
+    apps.push_back(string_at(m_applications[index].uid));
+  }
+  return apps;
+}
+
+std::vector<SessionSnapshot::Object>
+SessionSnapshot::modules(std::string_view app_uid) const {
+  std::vector<Object> mods;
+  auto end = m_applications + m_header->n_applications;
+  auto app = std::lower_bound(m_applications, end, app_uid,
+                              [this](const ApplicationRecord& rec, std::string_view uid) {
+                                return string_at(rec.uid) < uid;
+                              });
+  if (app == end || string_at(app->uid) != app_uid) {
+    return mods;
+  }
+  for (uint32_t index = app->first_module;
+       index < app->first_module + app->n_modules && index < m_header->n_modules;
+       index++) {
+    if (m_modules[index] < m_header->n_objects) {
+      mods.push_back(Object(this, &m_objects[m_modules[index]]));
+    }
+  }
+  return mods;
+}
+
+std::optional<SessionSnapshot::Object>
+SessionSnapshot::find(std::string_view uid, std::string_view class_name) const {
+  auto end = m_objects + m_header->n_objects;
+  auto obj = std::lower_bound(m_objects, end, std::make_pair(uid, class_name),
+                              [this](const ObjectRecord& rec,
+                                     const std::pair<std::string_view, std::string_view>& key) {
+                                return std::make_pair(string_at(rec.uid), string_at(rec.class_name)) < key;
+                              });
+  if (obj == end || string_at(obj->uid) != uid ||
+      (!class_name.empty() && string_at(obj->class_name) != class_name)) {
+    return std::nullopt;
+  }
+  return Object(this, obj);
+}
+
+std::string_view
+SessionSnapshot::Object::UID() const {
+  return m_snapshot->string_at(m_record->uid);
+}
+
+std::string_view
+SessionSnapshot::Object::class_name() const {
+  return m_snapshot->string_at(m_record->class_name);
+}
+
+std::vector<const ValueRecord*>
+SessionSnapshot::Object::find_values(std::string_view name) const {
+  std::vector<const ValueRecord*> found;
+  for (uint32_t index = m_record->first_value;
+       index < m_record->first_value + m_record->n_values && index < m_snapshot->m_header->n_values;
+       index++) {
+    if (m_snapshot->string_at(m_snapshot->m_values[index].name) == name) {
+      found.push_back(&m_snapshot->m_values[index]);
+    }
+  }
+  return found;
+}
+
+void
+SessionSnapshot::Object::missing_value(std::string_view name) const {
+  throw BadSnapshot(ERS_HERE, std::string(UID()), "no value for " + std::string(name));
+}
+
+bool
+SessionSnapshot::Object::has(std::string_view name) const {
+  return !find_values(name).empty() || !get_objs(name).empty();
+}
+
+std::optional<SessionSnapshot::Object>
+SessionSnapshot::Object::get_obj(std::string_view name) const {
+  auto objs = get_objs(name);
+  if (objs.empty()) {
+    return std::nullopt;
+  }
+  return objs[0];
+}
+
+std::vector<SessionSnapshot::Object>
+SessionSnapshot::Object::get_objs(std::string_view name) const {
+  std::vector<Object> objs;
+  for (uint32_t index = m_record->first_ref;
+       index < m_record->first_ref + m_record->n_refs && index < m_snapshot->m_header->n_refs;
+       index++) {
+    auto& ref = m_snapshot->m_refs[index];
+    if (m_snapshot->string_at(ref.name) == name &&
+        ref.target < m_snapshot->m_header->n_objects) {
+      objs.push_back(Object(m_snapshot, &m_snapshot->m_objects[ref.target]));
+    }
+  }
+  return objs;
+}
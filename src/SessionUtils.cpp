@@ -0,0 +1,243 @@
+/**
+ * @file SessionUtils.cpp
+ *
+ * Implementation of the session level generation helpers
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "readoutdal/SessionUtils.hpp"
+
+#include "CorePlanner.hpp"
+#include "GenerationPass.hpp"
+#include "PortAllocator.hpp"
+
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include "coredal/Application.hpp"
+#include "coredal/DaqModule.hpp"
+#include "coredal/NetworkDevice.hpp"
+#include "coredal/PhysicalHost.hpp"
+#include "coredal/ResourceBase.hpp"
+#include "coredal/Segment.hpp"
+#include "coredal/Session.hpp"
+#include "coredal/VirtualHost.hpp"
+
+#include "readoutdal/DFOApplication.hpp"
+#include "readoutdal/ReadoutApplication.hpp"
+#include "readoutdal/SmartDaqApplication.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <list>
+#include <string>
+#include <vector>
+
+using namespace dunedaq;
+using namespace dunedaq::readoutdal;
+
+static void
+add_segment_applications(const coredal::Segment* segment,
+                         const coredal::Session* session,
+                         std::vector<const SmartDaqApplication*>& apps) {
+  auto res = segment->cast<coredal::ResourceBase>();
+  if (res && res->disabled(*session)) {
+    TLOG_DEBUG(7) << "Ignoring disabled Segment " << segment->UID();
+    return;
+  }
+  for (auto app : segment->get_applications()) {
+    auto appRes = app->cast<coredal::ResourceBase>();
+    if (appRes && appRes->disabled(*session)) {
+      TLOG_DEBUG(7) << "Ignoring disabled Application " << app->UID();
+      continue;
+    }
+    auto smart = app->cast<SmartDaqApplication>();
+    if (smart) {
+      apps.push_back(smart);
+    }
+  }
+  for (auto seg : segment->get_segments()) {
+    add_segment_applications(seg, session, apps);
+  }
+}
+
+std::vector<const SmartDaqApplication*>
+dunedaq::readoutdal::get_smart_applications(const coredal::Session* session) {
+  std::vector<const SmartDaqApplication*> apps;
+  if (session->get_segment()) {
+    add_segment_applications(session->get_segment(), session, apps);
+  }
+  return apps;
+}
+
+std::string
+dunedaq::readoutdal::application_host(const coredal::Application* app) {
+  auto vhost = app->get_runs_on();
+  if (vhost == nullptr) {
+    return "localhost";
+  }
+  if (vhost->get_runs_on()) {
+    return vhost->get_runs_on()->UID();
+  }
+  return vhost->UID();
+}
+
+std::string
+dunedaq::readoutdal::application_data_ip(const coredal::Application* app) {
+  auto vhost = app->get_runs_on();
+  if (vhost == nullptr) {
+    return "";
+  }
+  for (auto component : vhost->get_uses()) {
+    auto nic = component->cast<coredal::NetworkDevice>();
+    if (nic == nullptr) {
+      continue;
+    }
+    for (auto& ip : nic->get_ip_address()) {
+      if (!ip.empty()) {
+        return ip;
+      }
+    }
+  }
+  return "";
+}
+
+namespace {
+
+  /// Name (without directory) of the file <stem>-<tag>.data.xml for dbfile
+  std::string
+  generated_file_name(const std::string& dbfile, const std::string& tag) {
+    std::string stem = std::filesystem::path(dbfile).filename().string();
+    const std::string suffix(".data.xml");
+    if (stem.size() > suffix.size() &&
+        stem.compare(stem.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      stem.erase(stem.size() - suffix.size());
+    }
+    return stem + "-" + tag + suffix;
+  }
+
+  /**
+   * The includes of dbfile other than the per-application files made
+   * for it, i.e. those a new application file should include
+   */
+  std::list<std::string>
+  base_includes(oksdbinterfaces::Configuration* confdb,
+                const std::string& dbfile) {
+    std::list<std::string> includes;
+    confdb->get_includes(dbfile, includes);
+    std::vector<const SmartDaqApplication*> apps;
+    confdb->get<SmartDaqApplication>(apps);
+    for (auto app : apps) {
+      includes.remove(generated_file_name(dbfile, app->UID()));
+    }
+    return includes;
+  }
+
+} // namespace
+
+std::string
+dunedaq::readoutdal::shared_dbfile(oksdbinterfaces::Configuration* confdb,
+                                   const std::string& dbfile) {
+  auto sharedFileName = generated_file_name(dbfile, "shared");
+  auto sharedFile = (std::filesystem::path(dbfile).parent_path() / sharedFileName).string();
+  if (!std::filesystem::exists(sharedFile)) {
+    TLOG_DEBUG(7) << "Creating database file " << sharedFile << " for shared objects";
+    auto includes = base_includes(confdb, dbfile);
+    includes.remove(sharedFileName);
+    confdb->create(sharedFile, includes);
+  }
+  std::list<std::string> dbIncludes;
+  confdb->get_includes(dbfile, dbIncludes);
+  if (std::find(dbIncludes.begin(), dbIncludes.end(), sharedFileName) == dbIncludes.end()) {
+    confdb->add_include(dbfile, sharedFileName);
+  }
+  return sharedFile;
+}
+
+std::string
+dunedaq::readoutdal::application_dbfile(oksdbinterfaces::Configuration* confdb,
+                                        const std::string& dbfile,
+                                        const SmartDaqApplication* app) {
+  auto appFileName = generated_file_name(dbfile, app->UID());
+  auto appFile = (std::filesystem::path(dbfile).parent_path() / appFileName).string();
+
+  // Objects shared with other applications go into the shared file
+  auto sharedFile = shared_dbfile(confdb, dbfile);
+  auto sharedFileName = std::filesystem::path(sharedFile).filename().string();
+  GenerationPass::instance().set_shared_file(sharedFile);
+
+  // The application file must not include the files of the other
+  // applications, or the last one created would load them all
+  auto includes = base_includes(confdb, dbfile);
+  if (std::find(includes.begin(), includes.end(), sharedFileName) == includes.end()) {
+    includes.push_back(sharedFileName);
+  }
+  if (!std::filesystem::exists(appFile)) {
+    TLOG_DEBUG(7) << "Creating database file " << appFile
+                  << " for objects of " << app->UID();
+    confdb->create(appFile, includes);
+  }
+  else {
+    // Files created before may include other application files
+    std::list<std::string> appIncludes;
+    confdb->get_includes(appFile, appIncludes);
+    std::vector<const SmartDaqApplication*> apps;
+    confdb->get<SmartDaqApplication>(apps);
+    for (auto other : apps) {
+      auto otherFileName = generated_file_name(dbfile, other->UID());
+      if (std::find(appIncludes.begin(), appIncludes.end(), otherFileName) != appIncludes.end()) {
+        confdb->remove_include(appFile, otherFileName);
+      }
+    }
+    if (std::find(appIncludes.begin(), appIncludes.end(), sharedFileName) == appIncludes.end()) {
+      confdb->add_include(appFile, sharedFileName);
+    }
+  }
+
+  std::list<std::string> dbIncludes;
+  confdb->get_includes(dbfile, dbIncludes);
+  if (std::find(dbIncludes.begin(), dbIncludes.end(), appFileName) == dbIncludes.end()) {
+    confdb->add_include(dbfile, appFileName);
+  }
+  return appFile;
+}
+
+std::vector<GeneratedApplication>
+dunedaq::readoutdal::generate_session_modules(oksdbinterfaces::Configuration* confdb,
+                                              const std::string& dbfile,
+                                              const coredal::Session* session,
+                                              bool per_app_files) {
+  PortAllocator::instance().reset(session->UID());
+  CoreAllocator::instance().reset(session->UID());
+
+  // Detect objects generated by more than one application, ending the
+  // pass however we leave
+  struct PassGuard {
+    PassGuard() { GenerationPass::instance().begin(); }
+    ~PassGuard() { GenerationPass::instance().end(); }
+  } guard;
+
+  // The DFApplications connect to the connections generated by the
+  // ReadoutApplications, and the DFO to those generated by the
+  // DFApplications, so generate in that order
+  auto apps = get_smart_applications(session);
+  auto rank = [](const SmartDaqApplication* app) {
+    return app->template cast<ReadoutApplication>() ? 0 : app->template cast<DFOApplication>() ? 2 : 1;
+  };
+  std::stable_sort(apps.begin(), apps.end(), [&rank](auto a, auto b) {
+    return rank(a) < rank(b);
+  });
+
+  std::vector<GeneratedApplication> generated;
+  for (auto app : apps) {
+    auto outfile = per_app_files ? application_dbfile(confdb, dbfile, app) : dbfile;
+    TLOG_DEBUG(7) << "Generating modules for " << app->UID() << " in " << outfile;
+    GenerationPass::instance().set_application(app->UID());
+    generated.push_back({app, app->generate_modules(confdb, outfile, session), outfile});
+  }
+  return generated;
+}
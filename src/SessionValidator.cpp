@@ -0,0 +1,296 @@
+/**
+ * @file SessionValidator.cpp
+ *
+ * Implementation of the resource checks of generated sessions
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "readoutdal/SessionValidator.hpp"
+
+#include "CorePlanner.hpp"
+#include "MemoryModel.hpp"
+#include "StreamRates.hpp"
+
+#include "coredal/DaqModule.hpp"
+#include "coredal/ProcessingResource.hpp"
+#include "coredal/Queue.hpp"
+#include "coredal/VirtualHost.hpp"
+
+#include "readoutdal/DataProcessor.hpp"
+#include "readoutdal/DataReader.hpp"
+#include "readoutdal/DataWriter.hpp"
+#include "readoutdal/DataWriterConf.hpp"
+#include "readoutdal/DLH.hpp"
+#include "readoutdal/DROStreamConf.hpp"
+#include "readoutdal/EthStreamParameters.hpp"
+#include "readoutdal/LatencyBuffer.hpp"
+#include "readoutdal/LinkHandlerConf.hpp"
+#include "readoutdal/NICReceiver.hpp"
+#include "readoutdal/NICReceiverConf.hpp"
+#include "readoutdal/ReadoutApplication.hpp"
+#include "readoutdal/ReadoutHost.hpp"
+#include "readoutdal/RoHwConfig.hpp"
+#include "readoutdal/SmartDaqApplication.hpp"
+#include "readoutdal/TPHandler.hpp"
+#include "readoutdal/TPHandlerConf.hpp"
+
+#include "readoutdalIssues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace dunedaq;
+using namespace dunedaq::readoutdal;
+
+namespace {
+
+  constexpr double mebibyte = 1024.0 * 1024.0;
+
+  const ReadoutHost*
+  readout_host(const SmartDaqApplication* app) {
+    return app->get_runs_on() ? app->get_runs_on()->cast<ReadoutHost>() : nullptr;
+  }
+
+  void
+  report(const std::vector<ResourceUsage>& usages, bool strict) {
+    for (auto& usage : usages) {
+      TLOG_DEBUG(7) << usage.resource << ": " << usage.demand << " of "
+                    << usage.capacity << " " << usage.unit;
+      if (usage.oversubscribed()) {
+        Oversubscribed issue(ERS_HERE, usage.resource, usage.demand,
+                             usage.capacity, usage.unit);
+        if (strict) {
+          throw issue;
+        }
+        ers::warning(issue);
+      }
+    }
+  }
+
+  struct MemoryTally {
+    const ReadoutHost* host = nullptr;
+    std::map<int, double> memory;    // bytes per NUMA node, -1 if not bound
+    std::map<int, double> hugepages; // bytes per NUMA node, -1 if not bound
+    bool writeBuffers = false;       // has asynchronous DataWriter buffers
+  };
+
+} // namespace
+
+std::vector<ResourceUsage>
+dunedaq::readoutdal::validate_memory(const std::vector<GeneratedApplication>& generated,
+                                     bool strict) {
+  std::map<std::string, MemoryTally> hosts;
+  for (auto& gen : generated) {
+    auto& tally = hosts[application_host(gen.application)];
+    if (tally.host == nullptr) {
+      tally.host = readout_host(gen.application);
+    }
+    const DataReaderConf* rdrConf = nullptr;
+    if (auto roApp = gen.application->cast<ReadoutApplication>()) {
+      rdrConf = roApp->get_data_reader();
+    }
+
+    for (auto module : gen.modules) {
+      // Write buffers of asynchronous DataWriters
+      if (auto dwr = module->cast<DataWriter>()) {
+        auto dwrConf = dwr->get_configuration();
+        if (dwrConf->get_write_mode() == "asynchronous") {
+          tally.memory[-1] += double(dwrConf->get_write_buffers()) * dwrConf->get_write_buffer_size();
+          tally.writeBuffers = true;
+        }
+        continue;
+      }
+      // TPHandler buffers hold TPs, not the packets the reader receives
+      const LatencyBuffer* lb = nullptr;
+      const DataReaderConf* packetConf = nullptr;
+      if (auto dlh = module->cast<DLH>()) {
+        lb = dlh->get_handler_configuration()->get_latency_buffer();
+        packetConf = rdrConf;
+      }
+      else if (auto tph = module->cast<TPHandler>()) {
+        lb = tph->get_handler_configuration()->get_latency_buffer();
+      }
+      if (lb == nullptr || !lb->get_preallocation()) {
+        continue;
+      }
+      // Input queues carry the same elements as the buffer
+      auto elementSize = buffer_element_size(lb, packetConf);
+      if (elementSize == 0) {
+        ers::warning(BadConf(ERS_HERE, "No element_size given for LatencyBuffer " + lb->UID() +
+                             " of " + module->UID() + ", its memory is not counted"));
+        continue;
+      }
+      uint64_t queueSlots = 0;
+      for (auto input : module->get_inputs()) {
+        if (auto queue = input->cast<coredal::Queue>()) {
+          queueSlots += queue->get_capacity();
+        }
+      }
+      auto lbBytes = latency_buffer_bytes(lb, lb->get_size(), elementSize, tally.host);
+      int node = lb->get_numa_aware() ? lb->get_numa_node() : -1;
+      tally.memory[node] += lbBytes + queueSlots * elementSize;
+      if (lb->get_intrinsic_allocator()) {
+        tally.hugepages[node] += lbBytes;
+      }
+    }
+  }
+
+  std::vector<ResourceUsage> usages;
+  for (auto& [name, tally] : hosts) {
+    double memory = 0;
+    double hugepages = 0;
+    double nodes = 1;
+    if (tally.host) {
+      memory = tally.host->get_memory_mb() * mebibyte;
+      hugepages = double(tally.host->get_hugepages()) * tally.host->get_hugepage_size_kb() * 1024;
+      nodes = std::max<uint16_t>(tally.host->get_numa_nodes(), 1);
+    }
+    // DF hosts are often plain VirtualHosts, leaving nothing to check
+    // the write buffers against
+    if (tally.writeBuffers && memory == 0) {
+      ers::warning(BadConf(ERS_HERE, "Memory of host " + name + " unknown, so the DataWriter"
+                           " write buffers are not checked (give it as a ReadoutHost with memory_mb)"));
+    }
+    double memoryTotal = 0;
+    for (auto& [node, bytes] : tally.memory) {
+      memoryTotal += bytes;
+      if (node >= 0) {
+        usages.push_back({name + "/numa" + std::to_string(node) + "/memory",
+                          bytes / mebibyte, memory / nodes / mebibyte, "MiB"});
+      }
+    }
+    double hugepageTotal = 0;
+    for (auto& [node, bytes] : tally.hugepages) {
+      hugepageTotal += bytes;
+      if (node >= 0) {
+        usages.push_back({name + "/numa" + std::to_string(node) + "/hugepages",
+                          bytes / mebibyte, hugepages / nodes / mebibyte, "MiB"});
+      }
+    }
+    usages.push_back({name + "/memory", memoryTotal / mebibyte, memory / mebibyte, "MiB"});
+    usages.push_back({name + "/hugepages", hugepageTotal / mebibyte, hugepages / mebibyte, "MiB"});
+  }
+  report(usages, strict);
+  return usages;
+}
+
+std::vector<ResourceUsage>
+dunedaq::readoutdal::validate_cpu(const std::vector<GeneratedApplication>& generated,
+                                  bool strict) {
+  std::map<std::string, double> threads;
+  std::map<std::string, std::set<uint16_t>> cores;
+  for (auto& gen : generated) {
+    auto host = application_host(gen.application);
+    auto& hostCores = cores[host];
+    auto add_cores = [&hostCores](const coredal::ProcessingResource* proc) {
+      if (proc) {
+        hostCores.insert(proc->get_cpu_cores().begin(), proc->get_cpu_cores().end());
+      }
+    };
+    if (auto vhost = gen.application->get_runs_on()) {
+      for (auto component : vhost->get_uses()) {
+        add_cores(component->cast<coredal::ProcessingResource>());
+      }
+    }
+    if (auto roApp = gen.application->cast<ReadoutApplication>()) {
+      if (auto hwConf = roApp->get_uses()) {
+        add_cores(hwConf->get_recv_processor());
+        add_cores(hwConf->get_hitFindingProc());
+      }
+    }
+
+    auto& hostThreads = threads[host];
+    for (auto module : gen.modules) {
+      if (auto dlh = module->cast<DLH>()) {
+        auto conf = dlh->get_handler_configuration();
+        hostThreads += conf->get_handlier_threads();
+        if (conf->get_data_processor() && conf->get_data_processor()->get_tpg_enabled()) {
+          hostThreads += 1;
+        }
+      }
+      else if (auto tph = module->cast<TPHandler>()) {
+        hostThreads += tph->get_handler_configuration()->get_handler_threads();
+      }
+      else if (auto reader = module->cast<DataReader>()) {
+        auto nicConf = reader->get_configuration()->cast<NICReceiverConf>();
+        size_t lcores = 0;
+        if (nicConf) {
+          lcores = parse_core_list(get_option(nicConf->get_eal_args(), "-l")).size();
+        }
+        hostThreads += std::max<size_t>(lcores, 1);
+      }
+    }
+  }
+
+  std::vector<ResourceUsage> usages;
+  for (auto& [host, count] : threads) {
+    usages.push_back({host + "/cpu", count, double(cores[host].size()), "threads"});
+  }
+  report(usages, strict);
+  return usages;
+}
+
+std::vector<ResourceUsage>
+dunedaq::readoutdal::validate_bandwidth(const std::vector<GeneratedApplication>& generated,
+                                        bool strict) {
+  constexpr double mbps = 1e6;
+  std::vector<ResourceUsage> usages;
+  std::map<std::string, std::pair<double, double>> ifaces; // demand, capacity
+  for (auto& gen : generated) {
+    auto host = application_host(gen.application);
+    for (auto module : gen.modules) {
+      auto receiver = module->cast<NICReceiver>();
+      if (receiver == nullptr) {
+        continue;
+      }
+      auto rdrConf = receiver->get_configuration();
+      auto nicConf = rdrConf->cast<NICReceiverConf>();
+      double linkSpeed = nicConf ? nicConf->get_link_speed_mbps() * mbps : 0;
+      double receiverRate = 0;
+      std::set<int> receiverIfaces;
+      for (auto stream : receiver->get_streams()) {
+        auto rate = stream_bandwidth(stream, rdrConf);
+        receiverRate += rate;
+        auto ethPars = stream->get_stream_params()->cast<EthStreamParameters>();
+        if (ethPars) {
+          receiverIfaces.insert(ethPars->get_rx_iface());
+          auto& iface = ifaces[host + "/rx_iface" + std::to_string(ethPars->get_rx_iface())];
+          iface.first += rate;
+          iface.second = linkSpeed;
+        }
+      }
+      usages.push_back({receiver->UID() + "/bandwidth", receiverRate / mbps,
+                        linkSpeed * std::max<size_t>(receiverIfaces.size(), 1) / mbps, "Mbit/s"});
+    }
+  }
+  for (auto& [name, iface] : ifaces) {
+    usages.push_back({name + "/bandwidth", iface.first / mbps, iface.second / mbps, "Mbit/s"});
+  }
+  for (auto& usage : usages) {
+    if (usage.capacity > 0) {
+      TLOG_DEBUG(7) << usage.resource << " utilisation "
+                    << 100.0 * usage.demand / usage.capacity << "%";
+    }
+  }
+  report(usages, strict);
+  return usages;
+}
+
+std::vector<ResourceUsage>
+dunedaq::readoutdal::validate_session(const std::vector<GeneratedApplication>& generated,
+                                      bool strict) {
+  auto usages = validate_memory(generated, strict);
+  auto cpu = validate_cpu(generated, strict);
+  usages.insert(usages.end(), cpu.begin(), cpu.end());
+  auto bandwidth = validate_bandwidth(generated, strict);
+  usages.insert(usages.end(), bandwidth.begin(), bandwidth.end());
+  return usages;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file StorageModel.hpp
+ *
+ * Alignment and size of the files written by generated modules, planned
+ * from the storage devices they write to
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef STORAGEMODEL_HPP
+#define STORAGEMODEL_HPP
+
+#include "ConfUtils.hpp"
+
+#include "oksdbinterfaces/ConfigObject.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#include "coredal/StorageDevice.hpp"
+
+#include "readoutdal/DataStorageDevice.hpp"
+#include "readoutdal/DataStoreConf.hpp"
+#include "readoutdal/HDF5FileLayoutParams.hpp"
+#include "readoutdal/HDF5PathParams.hpp"
+
+#include "readoutdalIssues.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+namespace dunedaq::readoutdal {
+
+  /**
+   * Block size in bytes of device, 0 if it is not known
+   */
+  inline uint32_t device_block_size(const coredal::StorageDevice* device) {
+    auto dataDevice = device ? device->cast<DataStorageDevice>() : nullptr;
+    return dataDevice ? dataDevice->get_block_size() : 0;
+  }
+
+  /**
+   * Round value up to a multiple of unit (unit 0 leaves it as is)
+   */
+  inline uint32_t round_up(uint32_t value, uint32_t unit) {
+    return unit == 0 ? value : (value + unit - 1) / unit * unit;
+  }
+
+  /**
+   * Changes to a DataStoreConf needed for one device. Writers needing
+   * the same changes share one generated copy of the DataStoreConf.
+   */
+  struct DataStoreVariant {
+    uint32_t alignment = 0;
+    uint64_t max_file_size = 0;
+
+    std::string suffix() const {
+      std::string sfx;
+      if (alignment > 0) {
+        sfx += "-align" + std::to_string(alignment);
+      }
+      if (max_file_size > 0) {
+        sfx += "-max" + std::to_string(max_file_size);
+      }
+      return sfx;
+    }
+  };
+
+  /**
+   * Work out how store should be changed for writers writing to
+   * device:
+   *
+   * - with O_DIRECT an alignment that is not a multiple of the block
+   *   size of the device is replaced by the block size rounded up to
+   *   the configured alignment
+   *
+   * - with a target_file_duration_s, max_file_size is set to what one
+   *   of writers writers sharing the device writes in that time at the
+   *   device's write_throughput_mbps (a multiple of the alignment)
+   *
+   * The free_space_safety_factor is then checked against the
+   * resulting file size and the capacity of the device.
+   */
+  inline DataStoreVariant plan_store(const DataStoreConf* store,
+                                     const coredal::StorageDevice* device,
+                                     size_t writers) {
+    DataStoreVariant variant;
+    auto dataDevice = device ? device->cast<DataStorageDevice>() : nullptr;
+
+    auto alignment = store->get_alignment();
+    auto block = device_block_size(device);
+    if (store->get_use_o_direct() && block != 0 &&
+        (alignment == 0 || alignment % block != 0)) {
+      alignment = round_up(std::max(alignment, block), block);
+      variant.alignment = alignment;
+    }
+
+    uint64_t maxFileSize = store->get_max_file_size();
+    if (store->get_target_file_duration_s() > 0) {
+      if (dataDevice == nullptr || dataDevice->get_write_throughput_mbps() == 0) {
+        ers::warning(BadConf(ERS_HERE, "No write_throughput_mbps known for the device of " +
+                             store->UID() + ", max_file_size not changed"));
+      }
+      else {
+        // write_throughput_mbps is in Mbit/s
+        uint64_t bytes = uint64_t(dataDevice->get_write_throughput_mbps()) * 1000000 / 8 *
+          store->get_target_file_duration_s() / std::max<size_t>(writers, 1);
+        if (alignment > 0) {
+          bytes = (bytes + alignment - 1) / alignment * alignment;
+        }
+        if (bytes != maxFileSize) {
+          maxFileSize = bytes;
+          variant.max_file_size = bytes;
+        }
+      }
+    }
+
+    // The writers stop when the free space falls below
+    // free_space_safety_factor times max_file_size
+    auto factor = store->get_free_space_safety_factor();
+    if (maxFileSize > 0 && factor < 1) {
+      ers::warning(BadConf(ERS_HERE, "free_space_safety_factor of " + store->UID() +
+                           " is less than 1, a file may not fit on the device"));
+    }
+    if (dataDevice && dataDevice->get_capacity_gb() > 0 && factor > 0 &&
+        double(factor) * maxFileSize > dataDevice->get_capacity_gb() * 1e9) {
+      throw (BadConf(ERS_HERE, "free_space_safety_factor of " + store->UID() +
+                     " times max_file_size exceeds the capacity of " + dataDevice->UID()));
+    }
+    return variant;
+  }
+
+  /**
+   * Make storeObj the copy of store with the changes plan_store()
+   * finds for device, or store itself if none are needed. Returns true
+   * if a copy is used.
+   */
+  inline bool store_variant(oksdbinterfaces::Configuration* confdb,
+                            const std::string& dbfile,
+                            const DataStoreConf* store,
+                            const coredal::StorageDevice* device,
+                            size_t writers,
+                            oksdbinterfaces::ConfigObject& storeObj) {
+    storeObj = store->config_object();
+    auto variant = plan_store(store, device, writers);
+    auto suffix = variant.suffix();
+    if (suffix.empty()) {
+      return false;
+    }
+    clone_shared_object(confdb, dbfile, store->config_object(), store->UID() + suffix, storeObj);
+    if (variant.alignment > 0) {
+      storeObj.set_by_val<uint32_t>("alignment", variant.alignment);
+      storeObj.set_by_val<uint32_t>("write_size",
+                                    round_up(store->get_write_size(), variant.alignment));
+    }
+    if (variant.max_file_size > 0) {
+      storeObj.set_by_val<uint64_t>("max_file_size", variant.max_file_size);
+    }
+    TLOG_DEBUG(7) << "Using DataStoreConf variant " << storeObj.UID();
+    return true;
+  }
+
+  /**
+   * Check that every detector group of layout that is compressed
+   * (after applying the overrides of its HDF5PathParams) has chunked
+   * datasets, as HDF5 can only apply filters to chunks.
+   */
+  inline void validate_file_layout(const HDF5FileLayoutParams* layout) {
+    if (layout == nullptr) {
+      return;
+    }
+    for (auto path : layout->get_path_params_list()) {
+      uint32_t chunkSize = path->get_override_chunk_size() ?
+        path->get_chunk_size() : layout->get_chunk_size();
+      uint32_t filter = path->get_override_compression() ?
+        path->get_compression_filter() : layout->get_compression_filter();
+      if (filter != 0 && chunkSize == 0) {
+        throw (BadConf(ERS_HERE, "Detector group " + path->get_detector_group_name() +
+                       " of " + layout->UID() + " is compressed but has no chunk_size"));
+      }
+    }
+  }
+
+} // namespace dunedaq::readoutdal
+#endif // STORAGEMODEL_HPP
@@ -0,0 +1,67 @@
+/**
+ * @file StreamRates.hpp
+ *
+ * Expected data rates of readout streams
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef STREAMRATES_HPP
+#define STREAMRATES_HPP
+
+#include "readoutdal/DataReaderConf.hpp"
+#include "readoutdal/DROStreamConf.hpp"
+#include "readoutdal/LatencyBuffer.hpp"
+#include "readoutdal/NICReceiverConf.hpp"
+#include "readoutdal/NICStatsConf.hpp"
+#include "readoutdal/StreamParameters.hpp"
+
+namespace dunedaq::readoutdal {
+
+  /// Frequency of the clock the data timestamps count
+  constexpr double clock_frequency_hz = 62.5e6;
+
+  /**
+   * Expected packet rate of a stream in Hz: the rate_hz of its
+   * StreamParameters if given, otherwise derived from the expected
+   * timestamp step between packets of the reader's NICStatsConf.
+   * Returns 0 if unknown.
+   */
+  inline double stream_packet_rate(const DROStreamConf* stream,
+                                   const DataReaderConf* rdrConf) {
+    auto params = stream->get_stream_params();
+    if (params && params->get_rate_hz() > 0) {
+      return params->get_rate_hz();
+    }
+    auto nicConf = rdrConf ? rdrConf->cast<NICReceiverConf>() : nullptr;
+    if (nicConf && nicConf->get_stats_conf() &&
+        nicConf->get_stats_conf()->get_expected_timestamp_step() > 0) {
+      return clock_frequency_hz / nicConf->get_stats_conf()->get_expected_timestamp_step();
+    }
+    return 0;
+  }
+
+  /**
+   * Expected bandwidth of a stream in bit/s: its packet rate times the
+   * expected packet size of the reader's NICStatsConf or, for other
+   * readers (e.g. FELIX), the element_size of lb, the latency buffer
+   * its packets are stored in. Returns 0 if unknown.
+   */
+  inline double stream_bandwidth(const DROStreamConf* stream,
+                                 const DataReaderConf* rdrConf,
+                                 const LatencyBuffer* lb = nullptr) {
+    double size = 0;
+    auto nicConf = rdrConf ? rdrConf->cast<NICReceiverConf>() : nullptr;
+    if (nicConf && nicConf->get_stats_conf()) {
+      size = nicConf->get_stats_conf()->get_expected_packet_size();
+    }
+    else if (lb) {
+      size = lb->get_element_size();
+    }
+    return stream_packet_rate(stream, rdrConf) * size * 8.0;
+  }
+
+} // namespace dunedaq::readoutdal
+#endif // STREAMRATES_HPP
@@ -8,20 +8,28 @@
  * received with this code.
  */
 
+#include "ConfUtils.hpp"
 #include "ModuleFactory.hpp"
+#include "StorageModel.hpp"
 
 #include "oksdbinterfaces/Configuration.hpp"
 #include "oks/kernel.hpp"
 #include "coredal/Connection.hpp"
 #include "coredal/NetworkConnection.hpp"
+#include "readoutdal/DataStoreConf.hpp"
+#include "readoutdal/FilenameParams.hpp"
+#include "readoutdal/TPWriter.hpp"
 #include "readoutdal/TPWriterApplication.hpp"
+#include "readoutdal/TPWriterConf.hpp"
 #include "readoutdal/NetworkConnectionRule.hpp"
 #include "readoutdal/NetworkConnectionDescriptor.hpp"
 #include "readoutdal/QueueConnectionRule.hpp"
 #include "readoutdal/QueueDescriptor.hpp"
+#include "readoutdal/SessionUtils.hpp"
 #include "readoutdalIssues.hpp"
 #include "logging/Logging.hpp"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -46,8 +54,87 @@ TPWriterApplication::generate_modules(oksdbinterfaces::Configuration* confdb,
 {
   std::vector<const coredal::DaqModule*> modules;
 
-  // Code to actually generate modules should go here
-  std::cout << __FUNCTION__ << " -- Unimplemented function\n";
+  auto tpwConf = get_tp_writer();
+  if (tpwConf == nullptr) {
+    throw (BadConf(ERS_HERE, "No TPWriter configuration given"));
+  }
+  auto host = application_host(this);
+  auto dataIp = application_data_ip(this);
+  uint32_t nWriters = std::max<uint32_t>(1, get_tp_writers());
+
+  // All the writers receive the TPs through the same connections and
+  // keep those of their own accumulation windows. The TP producers of
+  // other applications use them too, so they go in the shared file. A
+  // kPubSub connection is bound by its publishers rather than here,
+  // so its URI is left as the descriptor gives it.
+  std::vector<oksdbinterfaces::ConfigObject> inputObjs;
+  for (auto rule : get_network_rules()) {
+    if (rule->get_endpoint_class() == "TPWriter") {
+      auto desc = rule->get_descriptor();
+      if (nWriters > 1 && desc->get_connection_type() != "kPubSub") {
+        ers::warning(BadConf(ERS_HERE, "TPWriter input " + desc->get_uid_base() +
+                             " should be kPubSub to be shared by " +
+                             std::to_string(nWriters) + " writers"));
+      }
+      bool pubsub = desc->get_connection_type() == "kPubSub";
+      inputObjs.emplace_back();
+      create_network_connection(confdb, GenerationPass::instance().shared_file(dbfile),
+                                desc->get_uid_base(), desc, session,
+                                pubsub ? "" : host, pubsub ? "" : dataIp,
+                                inputObjs.back(), true);
+    }
+  }
+  std::vector<const oksdbinterfaces::ConfigObject*> inputs;
+  for (auto& obj : inputObjs) {
+    inputs.push_back(&obj);
+  }
+
+  // Fit the file alignment and size to the storage device, which all
+  // the writers share
+  auto storeConf = tpwConf->get_data_store_params();
+  validate_file_layout(storeConf->get_file_layout_params());
+  oksdbinterfaces::ConfigObject plannedStoreObj;
+  bool planned = store_variant(confdb, dbfile, storeConf, get_storage(), nWriters, plannedStoreObj);
+
+  for (uint32_t slice = 0; slice < nWriters; slice++) {
+    std::string suffix(nWriters > 1 ? "-" + std::to_string(slice) : "");
+
+    // With several writers each has its own copy of the configuration
+    // whose files are told apart by the writer_identifier
+    auto confObj = tpwConf->config_object();
+    auto storeObj = plannedStoreObj;
+    if (nWriters > 1) {
+      clone_object(confdb, dbfile, plannedStoreObj,
+                   storeConf->UID() + "-" + UID() + suffix, storeObj);
+      if (auto fnParams = storeConf->get_filename_params()) {
+        oksdbinterfaces::ConfigObject fnObj;
+        clone_object(confdb, dbfile, fnParams->config_object(),
+                     fnParams->UID() + "-" + UID() + suffix, fnObj);
+        auto writerId = fnParams->get_writer_identifier();
+        fnObj.set_by_val<std::string>("writer_identifier",
+                                      (writerId.empty() ? "" : writerId + "-") + UID() + suffix);
+        storeObj.set_obj("filename_params", &fnObj);
+      }
+    }
+    if (nWriters > 1 || planned) {
+      clone_object(confdb, dbfile, tpwConf->config_object(),
+                   tpwConf->UID() + "-" + UID() + suffix, confObj);
+      confObj.set_obj("data_store_params", &storeObj);
+    }
+
+    std::string tpwUid("tpwriter-" + UID() + suffix);
+    oksdbinterfaces::ConfigObject tpwObj;
+    create_object(confdb, dbfile, "TPWriter", tpwUid, tpwObj);
+    tpwObj.set_by_val<uint32_t>("window_modulo", nWriters);
+    tpwObj.set_by_val<uint32_t>("window_index", slice);
+    tpwObj.set_obj("configuration", &confObj);
+    if (get_storage()) {
+      auto deviceObj = get_storage()->config_object();
+      tpwObj.set_obj("storage", &deviceObj);
+    }
+    tpwObj.set_objs("inputs", inputs);
+    modules.push_back(confdb->get<TPWriter>(tpwUid));
+  }
 
   return modules;
 }
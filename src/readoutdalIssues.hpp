@@ -8,6 +8,17 @@ namespace dunedaq {
   ERS_DECLARE_ISSUE(readoutdal, BadStreamConf,
                     "Failed to cast stream parameters " << id << " to " << stype,
                     ((std::string)id) ((std::string)stype))
+  ERS_DECLARE_ISSUE(readoutdal, ResourceShortage,
+                    "Not enough resources in " << resource << ": " << what,
+                    ((std::string)resource) ((std::string)what))
+  ERS_DECLARE_ISSUE(readoutdal, Oversubscribed,
+                    resource << " is oversubscribed: " << demand << " " << unit
+                    << " needed, " << capacity << " available",
+                    ((std::string)resource) ((double)demand) ((double)capacity)
+                    ((std::string)unit))
+  ERS_DECLARE_ISSUE(readoutdal, BadSnapshot,
+                    "Session snapshot " << file << ": " << what,
+                    ((std::string)file) ((std::string)what))
 }
 
 
@@ -18,23 +18,77 @@
 
 #include "readoutdal/DFApplication.hpp"
 #include "readoutdal/DFOApplication.hpp"
+#include "readoutdal/GarbageCollector.hpp"
 #include "readoutdal/ReadoutApplication.hpp"
+#include "readoutdal/SessionSnapshot.hpp"
+#include "readoutdal/SessionUtils.hpp"
+#include "readoutdal/SessionValidator.hpp"
 #include "readoutdal/SmartDaqApplication.hpp"
 #include "readoutdal/TPWriterApplication.hpp"
 
 #include <string>
+#include <vector>
+
 using namespace dunedaq;
 
+static void usage(const char* prog) {
+  std::cout << "Usage: " << prog << " [--split] <session> <readout-app> <database-file>\n"
+            << "       " << prog << " --gc [--dry-run] [--split] <session> <database-file>\n"
+            << "       " << prog << " --snapshot <file> [--split] <session> <database-file>\n"
+            << "       " << prog << " --validate [--strict] <session> <database-file>\n"
+            << "  --split    Write the generated objects of each application to its\n"
+            << "             own file included from <database-file>\n"
+            << "  --gc       Regenerate all applications of the session and remove\n"
+            << "             generated objects they no longer produce\n"
+            << "  --dry-run  Only list the objects --gc would remove\n"
+            << "  --snapshot Generate all applications of the session and write\n"
+            << "             them to a binary snapshot <file>\n"
+            << "  --validate Generate all applications of the session and check the\n"
+            << "             resources they need against those of their hosts\n"
+            << "  --strict   Fail on the first oversubscribed resource\n";
+}
+
 int main(int argc, char* argv[]) {
-  if (argc < 4) {
-    std::cout << "Usage: " << argv[0] << " <session> <readout-app> <database-file>\n";
+  bool gc = false;
+  bool dryRun = false;
+  bool split = false;
+  std::string snapshotFile;
+  bool validate = false;
+  bool strict = false;
+  std::vector<std::string> args;
+  for (int arg = 1; arg < argc; arg++) {
+    std::string opt(argv[arg]);
+    if (opt == "--gc") {
+      gc = true;
+    }
+    else if (opt == "--dry-run") {
+      dryRun = true;
+    }
+    else if (opt == "--split") {
+      split = true;
+    }
+    else if (opt == "--validate") {
+      validate = true;
+    }
+    else if (opt == "--strict") {
+      strict = true;
+    }
+    else if (opt == "--snapshot" && arg + 1 < argc) {
+      snapshotFile = argv[++arg];
+    }
+    else {
+      args.push_back(opt);
+    }
+  }
+  bool sessionWide = gc || validate || !snapshotFile.empty();
+  if (args.size() < (sessionWide ? 2u : 3u)) {
+    usage(argv[0]);
     return 0;
   }
   logging::Logging::setup();
 
-  std::string sessionName(argv[1]);
-  std::string appName(argv[2]);
-  std::string dbfile(argv[3]);
+  std::string sessionName(args[0]);
+  std::string dbfile(args.back());
   auto confdb = new oksdbinterfaces::Configuration("oksconfig:" + dbfile);
 
   auto session = confdb->get<coredal::Session>(sessionName);
@@ -43,6 +97,41 @@ int main(int argc, char* argv[]) {
               << " from database\n";
     return 0;
   }
+
+  if (gc) {
+    auto removed = readoutdal::collect_garbage(confdb, dbfile, session, dryRun, split);
+    for (auto uid : removed) {
+      std::cout << (dryRun ? "Stale object " : "Removed ") << uid << std::endl;
+    }
+    std::cout << removed.size() << " stale objects found" << std::endl;
+    if (!dryRun && !removed.empty()) {
+      confdb->commit("Removed stale generated objects");
+    }
+    return 0;
+  }
+
+  if (validate) {
+    auto generated = readoutdal::generate_session_modules(confdb, dbfile, session);
+    int failures = 0;
+    for (auto& usage : readoutdal::validate_session(generated, strict)) {
+      std::cout << (usage.oversubscribed() ? "OVER " : "ok   ") << usage.resource << ": "
+                << usage.demand << " / " << usage.capacity << " " << usage.unit << std::endl;
+      failures += usage.oversubscribed();
+    }
+    return failures ? 1 : 0;
+  }
+
+  if (!snapshotFile.empty()) {
+    auto generated = readoutdal::generate_session_modules(confdb, dbfile, session, split);
+    readoutdal::write_session_snapshot(confdb, generated, snapshotFile);
+    readoutdal::SessionSnapshot snapshot(snapshotFile);
+    for (auto app : snapshot.applications()) {
+      std::cout << app << ": " << snapshot.modules(app).size() << " modules\n";
+    }
+    return 0;
+  }
+
+  std::string appName(args[1]);
   auto daqapp = confdb->get<coredal::Application>(appName);
   if (daqapp) {
     std::cout << appName << " is of class " << daqapp->class_name() << std::endl;
@@ -55,7 +144,8 @@ int main(int argc, char* argv[]) {
     std::vector<const coredal::DaqModule*> modules;
     auto smart = daqapp->cast<readoutdal::SmartDaqApplication>();
     if (smart) {
-      modules = smart->generate_modules(confdb, dbfile, session);
+      auto outfile = split ? readoutdal::application_dbfile(confdb, dbfile, smart) : dbfile;
+      modules = smart->generate_modules(confdb, outfile, session);
     }
     else {
       std::cout << appName << " failed to cast to SmartDaqApplication\n";
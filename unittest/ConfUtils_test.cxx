@@ -0,0 +1,50 @@
+/**
+ * @file ConfUtils_test.cxx
+ *
+ * Unit tests of the URI helpers used for generated NetworkConnections
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "../src/ConfUtils.hpp"
+
+#define BOOST_TEST_MODULE ConfUtils_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+
+using namespace dunedaq::readoutdal;
+
+BOOST_AUTO_TEST_SUITE(ConfUtils_test)
+
+BOOST_AUTO_TEST_CASE(UriHost)
+{
+  BOOST_REQUIRE_EQUAL(uri_host("tcp://10.0.0.1:1234"), "10.0.0.1");
+  BOOST_REQUIRE_EQUAL(uri_host("tcp://0.0.0.0:*"), "0.0.0.0");
+  BOOST_REQUIRE_EQUAL(uri_host("tcp://myhost"), "myhost");
+  BOOST_REQUIRE_EQUAL(uri_host("inproc-name"), "");
+}
+
+BOOST_AUTO_TEST_CASE(ResolveWildcards)
+{
+  BOOST_REQUIRE_EQUAL(resolve_uri("tcp://0.0.0.0:*", "10.0.0.1", 1234), "tcp://10.0.0.1:1234");
+  BOOST_REQUIRE_EQUAL(resolve_uri("tcp://*:*", "10.0.0.1", 1234), "tcp://10.0.0.1:1234");
+  BOOST_REQUIRE_EQUAL(resolve_uri("tcp://:*", "10.0.0.1", 1234), "tcp://10.0.0.1:1234");
+}
+
+BOOST_AUTO_TEST_CASE(ResolveKeepsSpecificParts)
+{
+  // Explicit host and port are kept
+  BOOST_REQUIRE_EQUAL(resolve_uri("tcp://192.168.1.1:5000", "10.0.0.1", 1234),
+                      "tcp://192.168.1.1:5000");
+  // No ip or port to substitute
+  BOOST_REQUIRE_EQUAL(resolve_uri("tcp://0.0.0.0:*", "", 0), "tcp://0.0.0.0:*");
+  BOOST_REQUIRE_EQUAL(resolve_uri("tcp://0.0.0.0:*", "", 1234), "tcp://0.0.0.0:1234");
+  // Not a URI with a host at all
+  BOOST_REQUIRE_EQUAL(resolve_uri("inproc", "10.0.0.1", 1234), "inproc");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,77 @@
+/**
+ * @file CorePlanner_test.cxx
+ *
+ * Unit tests of the core list helpers and the session wide core
+ * allocation
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "../src/CorePlanner.hpp"
+
+#define BOOST_TEST_MODULE CorePlanner_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::readoutdal;
+
+BOOST_AUTO_TEST_SUITE(CorePlanner_test)
+
+BOOST_AUTO_TEST_CASE(ParseCoreList)
+{
+  std::vector<uint16_t> expected{0, 1, 2, 3, 8, 10, 11};
+  auto cores = parse_core_list("0-3,8,10-11");
+  BOOST_CHECK_EQUAL_COLLECTIONS(cores.begin(), cores.end(), expected.begin(), expected.end());
+  BOOST_REQUIRE(parse_core_list("").empty());
+  BOOST_REQUIRE_EQUAL(format_core_list(cores), "0,1,2,3,8,10,11");
+  BOOST_REQUIRE_THROW(parse_core_list("1,x"), dunedaq::readoutdal::BadConf);
+}
+
+BOOST_AUTO_TEST_CASE(GetOption)
+{
+  BOOST_REQUIRE_EQUAL(get_option("-l 0-3 -n 4", "-l"), "0-3");
+  BOOST_REQUIRE_EQUAL(get_option("-l 0-3 -n 4", "-m"), "");
+  BOOST_REQUIRE_EQUAL(get_option("-n", "-n"), "");
+}
+
+BOOST_AUTO_TEST_CASE(SetEalLcores)
+{
+  BOOST_REQUIRE_EQUAL(set_eal_lcores("-l 0-2 -m [0:1-2].0 -n 4", {10, 11, 12}),
+                      "-l 10,11,12 -m [10:11,12].0 -n 4");
+  BOOST_REQUIRE_EQUAL(set_eal_lcores("-l 0 -m [0:0].0", {7}), "-l 7 -m [7:7].0");
+  // Every group of a multi-port map keeps its number of cores
+  BOOST_REQUIRE_EQUAL(set_eal_lcores("-l 0-3 -m [0:1].0,[2:3].1", {10, 11, 12, 13}),
+                      "-l 10,11,12,13 -m [10:11].0,[12:13].1");
+  BOOST_REQUIRE_EQUAL(set_eal_lcores("-l 0-3", {}), "-l 0-3");
+}
+
+BOOST_AUTO_TEST_CASE(SessionWideAllocation)
+{
+  CoreAllocator::instance().reset("session");
+  std::vector<uint16_t> pool{1, 2, 3, 4};
+  CorePlanner app1("app1", "session", "host", pool);
+  CorePlanner app2("app2", "session", "host", pool);
+  CorePlanner other("other", "session", "otherhost", pool);
+  BOOST_REQUIRE(app1.enabled());
+  BOOST_REQUIRE(!CorePlanner("empty", "session", "host", {1}, {1}).enabled());
+
+  auto cores1 = app1.allocate(2, "dlh1");
+  auto cores2 = app2.allocate(2, "dlh2");
+  BOOST_REQUIRE_EQUAL(format_core_list(cores1), "1,2");
+  BOOST_REQUIRE_EQUAL(format_core_list(cores2), "3,4");
+  BOOST_REQUIRE(app2.allocate(1, "dlh3").empty());
+  BOOST_REQUIRE_EQUAL(format_core_list(other.allocate(1, "dlh4")), "1");
+  // Regenerating gives a module its cores back
+  BOOST_REQUIRE_EQUAL(format_core_list(app1.allocate(2, "dlh1")), "1,2");
+
+  CoreAllocator::instance().reset("session");
+  BOOST_REQUIRE_EQUAL(format_core_list(app2.allocate(2, "dlh2")), "1,2");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
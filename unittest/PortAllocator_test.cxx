@@ -0,0 +1,73 @@
+/**
+ * @file PortAllocator_test.cxx
+ *
+ * Unit tests of the session wide port allocation
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "../src/PortAllocator.hpp"
+
+#define BOOST_TEST_MODULE PortAllocator_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <string>
+
+using namespace dunedaq::readoutdal;
+
+BOOST_AUTO_TEST_SUITE(PortAllocator_test)
+
+BOOST_AUTO_TEST_CASE(Ephemeral)
+{
+  auto& allocator = PortAllocator::instance();
+  allocator.reset("ephemeral");
+  BOOST_REQUIRE_EQUAL(allocator.allocate("ephemeral", "host", "conn", 0), 0);
+  BOOST_REQUIRE(!allocator.has_host("ephemeral", "host"));
+}
+
+BOOST_AUTO_TEST_CASE(DistinctPortsPerHost)
+{
+  auto& allocator = PortAllocator::instance();
+  allocator.reset("distinct");
+  BOOST_REQUIRE_EQUAL(allocator.allocate("distinct", "host1", "a", 5000), 5000);
+  BOOST_REQUIRE_EQUAL(allocator.allocate("distinct", "host1", "b", 5000), 5001);
+  BOOST_REQUIRE_EQUAL(allocator.allocate("distinct", "host2", "c", 5000), 5000);
+  // The same connection gets the same port again
+  BOOST_REQUIRE_EQUAL(allocator.allocate("distinct", "host1", "a", 5000), 5000);
+  allocator.reset("distinct");
+  BOOST_REQUIRE_EQUAL(allocator.allocate("distinct", "host1", "b", 5000), 5000);
+}
+
+BOOST_AUTO_TEST_CASE(PreferredPort)
+{
+  auto& allocator = PortAllocator::instance();
+  allocator.reset("preferred");
+  BOOST_REQUIRE_EQUAL(allocator.allocate("preferred", "host", "a", 5000, 5010), 5010);
+  // Taken by a, so b gets the base
+  BOOST_REQUIRE_EQUAL(allocator.allocate("preferred", "host", "b", 5000, 5010), 5000);
+  // Below the base
+  BOOST_REQUIRE_EQUAL(allocator.allocate("preferred", "host", "c", 5000, 4000), 5001);
+}
+
+BOOST_AUTO_TEST_CASE(Reserved)
+{
+  auto& allocator = PortAllocator::instance();
+  allocator.reset("reserved");
+  BOOST_REQUIRE(allocator.reserve("reserved", "host", "old", 6000));
+  BOOST_REQUIRE(allocator.reserve("reserved", "host", "user", 6001));
+  BOOST_REQUIRE(!allocator.reserve("reserved", "host", "other", 6001));
+  BOOST_REQUIRE(!allocator.reserve("reserved", "host", "none", 0));
+  BOOST_REQUIRE(allocator.has_host("reserved", "host"));
+
+  // Reserved ports are avoided by new connections
+  BOOST_REQUIRE_EQUAL(allocator.allocate("reserved", "host", "new", 6000), 6002);
+  // and given back to the connection that had them
+  BOOST_REQUIRE_EQUAL(allocator.allocate("reserved", "host", "old", 6000, 6000), 6000);
+  // unless the base has been raised above them
+  BOOST_REQUIRE_EQUAL(allocator.allocate("reserved", "host", "user", 7000, 6001), 7000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,181 @@
+/**
+ * @file SessionSnapshot_test.cxx
+ *
+ * Unit tests of writing and reading back binary session snapshots
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2023.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "readoutdal/SessionSnapshot.hpp"
+#include "readoutdal/SmartDaqApplication.hpp"
+#include "../src/readoutdalIssues.hpp"
+
+#include "coredal/DaqModule.hpp"
+#include "oksdbinterfaces/Configuration.hpp"
+
+#define BOOST_TEST_MODULE SessionSnapshot_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace dunedaq;
+using namespace dunedaq::readoutdal;
+
+namespace {
+
+  std::string
+  read_file(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), {});
+  }
+
+  void
+  write_file(const std::string& filename, const std::string& data) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), data.size());
+  }
+
+  /// A database with one application and two DLHs sharing a conf,
+  /// written to a snapshot
+  struct SnapshotFixture {
+    SnapshotFixture() {
+      auto tmp = std::filesystem::temp_directory_path();
+      auto tag = std::to_string(getpid());
+      dbfile = (tmp / ("SessionSnapshot_test-" + tag + ".data.xml")).string();
+      snapfile = (tmp / ("SessionSnapshot_test-" + tag + ".snap")).string();
+
+      oksdbinterfaces::Configuration db("oksconfig");
+      db.create(dbfile, {"schema/readoutdal/readout.schema.xml"});
+
+      oksdbinterfaces::ConfigObject lb;
+      db.create(dbfile, "LatencyBuffer", "lb-test", lb);
+      lb.set_by_val<uint32_t>("size", 2048);
+      lb.set_by_val<bool>("numa_aware", false);
+      lb.set_by_val<int16_t>("numa_node", -1);
+
+      oksdbinterfaces::ConfigObject conf;
+      db.create(dbfile, "LinkHandlerConf", "lhconf-test", conf);
+      conf.set_by_val<uint32_t>("request_timeout", 500);
+      conf.set_by_val<std::string>("output_file", "out.bin");
+      conf.set_obj("latency_buffer", &lb);
+
+      for (uint32_t sid : {100u, 101u}) {
+        oksdbinterfaces::ConfigObject dlh;
+        db.create(dbfile, "FDDataLinkHandler", "DLH-" + std::to_string(sid), dlh);
+        dlh.set_by_val<uint32_t>("source_id", sid);
+        dlh.set_by_val<std::vector<uint16_t>>("cpu_affinity", {3, 4});
+        dlh.set_obj("handler_configuration", &conf);
+      }
+
+      oksdbinterfaces::ConfigObject app;
+      db.create(dbfile, "ReadoutApplication", "ru-01", app);
+      db.commit();
+
+      GeneratedApplication gen{db.get<SmartDaqApplication>("ru-01"),
+                               {db.get<coredal::DaqModule>("DLH-100"),
+                                db.get<coredal::DaqModule>("DLH-101")},
+                               dbfile};
+      write_session_snapshot(&db, {gen}, snapfile);
+    }
+
+    ~SnapshotFixture() {
+      std::filesystem::remove(dbfile);
+      std::filesystem::remove(snapfile);
+    }
+
+    std::string dbfile;
+    std::string snapfile;
+  };
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(SessionSnapshot_test, SnapshotFixture)
+
+BOOST_AUTO_TEST_CASE(Applications)
+{
+  SessionSnapshot snap(snapfile);
+  BOOST_REQUIRE_EQUAL(snap.version(), snapshot::format_version);
+
+  auto apps = snap.applications();
+  BOOST_REQUIRE_EQUAL(apps.size(), 1u);
+  BOOST_REQUIRE_EQUAL(apps[0], "ru-01");
+
+  auto modules = snap.modules("ru-01");
+  BOOST_REQUIRE_EQUAL(modules.size(), 2u);
+  BOOST_REQUIRE_EQUAL(modules[0].UID(), "DLH-100");
+  BOOST_REQUIRE_EQUAL(modules[1].UID(), "DLH-101");
+  BOOST_REQUIRE(snap.modules("ru-02").empty());
+}
+
+BOOST_AUTO_TEST_CASE(Values)
+{
+  SessionSnapshot snap(snapfile);
+  auto dlh = snap.find("DLH-100");
+  BOOST_REQUIRE(dlh.has_value());
+  BOOST_REQUIRE_EQUAL(dlh->class_name(), "FDDataLinkHandler");
+  BOOST_REQUIRE_EQUAL(dlh->get<uint32_t>("source_id"), 100u);
+  BOOST_REQUIRE(dlh->get_values<uint16_t>("cpu_affinity") == std::vector<uint16_t>({3, 4}));
+
+  BOOST_REQUIRE(!dlh->has("no_such_attribute"));
+  BOOST_REQUIRE_THROW(dlh->get<uint32_t>("no_such_attribute"), BadSnapshot);
+}
+
+BOOST_AUTO_TEST_CASE(References)
+{
+  SessionSnapshot snap(snapfile);
+  auto dlh = snap.find("DLH-101");
+  BOOST_REQUIRE(dlh.has_value());
+
+  auto conf = dlh->get_obj("handler_configuration");
+  BOOST_REQUIRE(conf.has_value());
+  BOOST_REQUIRE_EQUAL(conf->UID(), "lhconf-test");
+  BOOST_REQUIRE_EQUAL(conf->get<uint32_t>("request_timeout"), 500u);
+  BOOST_REQUIRE_EQUAL(conf->get<std::string>("output_file"), "out.bin");
+
+  auto lb = conf->get_obj("latency_buffer");
+  BOOST_REQUIRE(lb.has_value());
+  BOOST_REQUIRE_EQUAL(lb->UID(), "lb-test");
+  BOOST_REQUIRE_EQUAL(lb->get<uint32_t>("size"), 2048u);
+  BOOST_REQUIRE_EQUAL(lb->get<bool>("numa_aware"), false);
+  BOOST_REQUIRE_EQUAL(lb->get<int16_t>("numa_node"), -1);
+
+  BOOST_REQUIRE(!conf->get_obj("data_processor").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(Lookup)
+{
+  SessionSnapshot snap(snapfile);
+  BOOST_REQUIRE(snap.find("lhconf-test", "LinkHandlerConf").has_value());
+  BOOST_REQUIRE(!snap.find("lhconf-test", "LatencyBuffer").has_value());
+  BOOST_REQUIRE(!snap.find("no-such-object").has_value());
+}
+
+BOOST_AUTO_TEST_CASE(BadFiles)
+{
+  auto data = read_file(snapfile);
+  BOOST_REQUIRE(data.size() > sizeof(snapshot::Header));
+
+  write_file(snapfile, data.substr(0, sizeof(snapshot::Header) - 1));
+  BOOST_REQUIRE_THROW(SessionSnapshot{snapfile}, BadSnapshot);
+
+  write_file(snapfile, data.substr(0, data.size() - 1));
+  BOOST_REQUIRE_THROW(SessionSnapshot{snapfile}, BadSnapshot);
+
+  auto badMagic = data;
+  badMagic[0] ^= 0xff;
+  write_file(snapfile, badMagic);
+  BOOST_REQUIRE_THROW(SessionSnapshot{snapfile}, BadSnapshot);
+
+  std::filesystem::remove(snapfile);
+  BOOST_REQUIRE_THROW(SessionSnapshot{snapfile}, BadSnapshot);
+}
+
+BOOST_AUTO_TEST_SUITE_END()